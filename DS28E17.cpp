@@ -18,12 +18,39 @@ MIT License
 
 DS28E17::DS28E17()
 {
+  bus = NULL;
+  error = DS28E17_ERROR_NONE;
+  pendingCommand = 0;
+  pendingLength = 0;
+  broadcast = false;
 }
 
 
 DS28E17::DS28E17(OneWire *oneWireW)
 {
-  oneWire = oneWireW;
+  pinBus = OneWirePinBus(oneWireW);
+  bus = NULL;
+  error = DS28E17_ERROR_NONE;
+  pendingCommand = 0;
+  pendingLength = 0;
+  broadcast = false;
+}
+
+
+DS28E17::DS28E17(OneWireBus *oneWireBus)
+{
+  bus = oneWireBus;
+  error = DS28E17_ERROR_NONE;
+  pendingCommand = 0;
+  pendingLength = 0;
+  broadcast = false;
+}
+
+
+OneWireBus *DS28E17::getBus()
+{
+  // pinBus is resolved here so that copies of this object stay valid
+  return bus != NULL ? bus : &pinBus;
 }
 
 
@@ -35,59 +62,155 @@ void DS28E17::setAddress(uint8_t *sensorAddress)
 
 void DS28E17::wakeUp()
 {
-  oneWire->depower();
-  oneWire->reset();
+  getBus()->depower();
+  getBus()->reset();
   delay(2);
 }
 
 
 void DS28E17::enableSleepMode()
 {
-  oneWire->reset();
-  oneWire->select(address);
-  oneWire->write(DS28E17_ENABLE_SLEEP, 0);    
+  getBus()->reset();
+  getBus()->select(address);
+  getBus()->write(DS28E17_ENABLE_SLEEP);    
+}
+
+
+void DS28E17::enableSleepModeAll()
+{
+  getBus()->reset();
+  getBus()->skip();
+  getBus()->write(DS28E17_ENABLE_SLEEP);    
+}
+
+
+bool DS28E17::verify()
+{
+  if (!getBus()->reset()) {
+    error = DS28E17_ERROR_PRESENCE;
+    return false;
+  }
+  getBus()->select(address);
+  getBus()->write(DS28E17_READ_CONFIG);
+
+  // Nobody drives the bus if the ROM did not match, so all ones are read
+  uint8_t config = getBus()->read();
+  getBus()->depower();
+
+  error = config != 0xFF ? DS28E17_ERROR_NONE : DS28E17_ERROR_PRESENCE;
+
+  return error == DS28E17_ERROR_NONE;
+}
+
+
+ds28e17Error DS28E17::lastError()
+{
+  return error;
+}
+
+
+ds28e17Error DS28E17::_decodeStatus(uint8_t stat, uint8_t writeStat)
+{
+  if (stat & DS28E17_STATUS_CRC) {
+    return DS28E17_ERROR_CRC;
+  }
+  if (stat & DS28E17_STATUS_ADDRESS_NACK) {
+    return DS28E17_ERROR_ADDRESS_NACK;
+  }
+  // Other bits of the status are reserved
+  if (stat & DS28E17_STATUS_START) {
+    return DS28E17_ERROR_START;
+  }
+  if (writeStat != 0x00) {
+    return DS28E17_ERROR_WRITE_NACK;
+  }
+  return DS28E17_ERROR_NONE;
 }
 
 
-bool DS28E17::_writeTo(uint8_t *header, uint8_t headerLength, uint8_t *data, uint8_t dataLength)
+bool DS28E17::_send(uint8_t *header, uint8_t headerLength, uint8_t *data, uint8_t dataLength)
 {
   uint8_t crc[2];
-  uint16_t crc16 = oneWire->crc16(&header[0], headerLength);
-  crc16 = oneWire->crc16(&data[0], dataLength, crc16);
+  uint16_t crc16 = OneWire::crc16(&header[0], headerLength);
+  crc16 = OneWire::crc16(&data[0], dataLength, crc16);
   crc16 = ~crc16;
   crc[1] = crc16 >> 8;                 
   crc[0] = crc16 & 0xFF;               
   
-  oneWire->reset();
-  oneWire->select(address);
-  oneWire->write_bytes(header, headerLength, 0);
-  oneWire->write_bytes(data, dataLength, 0);
-  oneWire->write_bytes(crc, sizeof(crc), 0);
+  // A missing device is detected here instead of waiting for the busy timeout
+  if (!getBus()->reset()) {
+    error = DS28E17_ERROR_PRESENCE;
+    return false;
+  }
+  if (broadcast) {
+    getBus()->skip();
+  }
+  else {
+    getBus()->select(address);
+  }
+  getBus()->write_bytes(header, headerLength);
+  getBus()->write_bytes(data, dataLength);
+  getBus()->write_bytes(crc, sizeof(crc));
 
+  return true;
+}
+
+bool DS28E17::_wait()
+{
   uint8_t timeout = 0;
-  while (oneWire->read_bit() == true){
+  while (isBusy()){
     delay(1);
     timeout++;
     if (timeout > ONEWIRE_TIMEOUT){
-      oneWire->depower();
+      abort();
       return false;
     }
   }
+  return true;
+}
 
-  uint8_t stat = oneWire->read();
-  uint8_t writeStat = oneWire->read();
+bool DS28E17::isBusy()
+{
+  // The request is still being sent, so the busy bit cannot be read yet
+  if (!getBus()->isIdle()) {
+    return true;
+  }
+  return getBus()->read_bit() == true;
+}
+
+void DS28E17::abort()
+{
+  getBus()->depower();
+  error = DS28E17_ERROR_TIMEOUT;
+}
+
+bool DS28E17::end(uint8_t *buffer)
+{
+  uint8_t stat = getBus()->read();
+  uint8_t writeStat = pendingCommand == DS28E17_READ ? 0 : getBus()->read();
   
-  if ((stat != 0x00) || (writeStat != 0x00)) {
-    oneWire->depower();
+  error = _decodeStatus(stat, writeStat);
+
+  if (error != DS28E17_ERROR_NONE) {
+    getBus()->depower();
     return false;
   }
-  
-  oneWire->depower(); 
 
-  return true;    
+  /*Serial.print("Status =");
+  Serial.println(stat,BIN);
+  Serial.print("Write Status =");
+  Serial.println(write_stat,BIN);*/
+
+  for (int i=0; i<pendingLength; i++){
+    buffer[i] = getBus()->read();
+  }
+
+  getBus()->depower(); 
+  
+  return true; 
 }
 
-bool DS28E17::write(uint8_t i2cAddress, uint8_t *data, uint8_t dataLength)
+bool DS28E17::beginWrite(uint8_t i2cAddress, uint8_t *data, uint8_t dataLength)
 {
   uint8_t header[3];
   uint8_t headerLength = 3;
@@ -96,10 +219,18 @@ bool DS28E17::write(uint8_t i2cAddress, uint8_t *data, uint8_t dataLength)
   header[1] = i2cAddress << 1;      // 7 bit i2c Address
   header[2] = dataLength;           // number of bytes to be written 
 
-  return _writeTo(header, headerLength, data, dataLength);    
+  pendingCommand = DS28E17_WRITE;
+  pendingLength = 0;
+
+  return _send(header, headerLength, data, dataLength);    
 }
 
-bool DS28E17::memoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength)
+bool DS28E17::write(uint8_t i2cAddress, uint8_t *data, uint8_t dataLength)
+{
+  return beginWrite(i2cAddress, data, dataLength) && _wait() && end(NULL);
+}
+
+bool DS28E17::beginMemoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength)
 {
   uint8_t header[5];
   uint8_t headerLength;
@@ -119,55 +250,37 @@ bool DS28E17::memoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data
     header[2] = dataLength + 1;       // number of bytes to be written 
     header[3] = i2cRegister;          // i2c device register address  
   }
-  return _writeTo(header, headerLength, data, dataLength);     
+
+  pendingCommand = DS28E17_WRITE;
+  pendingLength = 0;
+
+  return _send(header, headerLength, data, dataLength);     
 }
 
-bool DS28E17::_readFrom(uint8_t *header, uint8_t headerLength, uint8_t *buffer, uint8_t bufferLength)
-{   
-  uint8_t crc[2];
-  uint16_t crc16 = oneWire->crc16(&header[0], headerLength);
-  crc16 = ~crc16;
-  crc[1] = crc16 >> 8;                 
-  crc[0] = crc16 & 0xFF;               
-  
-  oneWire->reset();
-  oneWire->select(address);
-  oneWire->write_bytes(header, headerLength, 0);
-  oneWire->write_bytes(crc, sizeof(crc), 0);
+bool DS28E17::memoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength)
+{
+  return beginMemoryWrite(i2cAddress, i2cRegister, data, dataLength) && _wait() && end(NULL);
+}
 
-  uint8_t timeout = 0;
-  while (oneWire->read_bit() == true){
-    delay(1);
-    timeout++;
-    if (timeout > ONEWIRE_TIMEOUT){
-      oneWire->depower();
-      return false;
-    }
-  }
-  
-  uint8_t stat = oneWire->read();
-  uint8_t writeStat = header[0] == DS28E17_READ ? 0 : oneWire->read();
-  
-  if ((stat != 0x00) || (writeStat != 0x00)) {
-    oneWire->depower();
+bool DS28E17::memoryWriteAll(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength)
+{
+  broadcast = true;
+  bool sent = beginMemoryWrite(i2cAddress, i2cRegister, data, dataLength);
+  broadcast = false;
+
+  if (!sent) {
     return false;
   }
 
-  /*Serial.print("Status =");
-  Serial.println(stat,BIN);
-  Serial.print("Write Status =");
-  Serial.println(write_stat,BIN);*/
-
-  for (int i=0; i<bufferLength; i++){
-    buffer[i] = oneWire->read();
-  }
+  // Busy bits and status of many devices collide on the bus, so wait instead
+  delay(DS28E17_BROADCAST_WAIT);
+  getBus()->depower();
+  error = DS28E17_ERROR_NONE;
 
-  oneWire->depower(); 
-  
-  return true; 
+  return true;
 }
 
-bool DS28E17::read(uint8_t i2cAddress, uint8_t *buffer, uint8_t bufferLength)
+bool DS28E17::beginRead(uint8_t i2cAddress, uint8_t bufferLength)
 {
   uint8_t header[3];
   uint8_t headerLength = 3;
@@ -176,11 +289,18 @@ bool DS28E17::read(uint8_t i2cAddress, uint8_t *buffer, uint8_t bufferLength)
   header[1] = i2cAddress << 1 | 0x01; // 7 bit i2c Address
   header[2] = bufferLength;           // number of bytes to be read
 
-  return _readFrom(header, headerLength, buffer, bufferLength); 
+  pendingCommand = DS28E17_READ;
+  pendingLength = bufferLength;
+
+  return _send(header, headerLength, NULL, 0); 
 }
 
+bool DS28E17::read(uint8_t i2cAddress, uint8_t *buffer, uint8_t bufferLength)
+{
+  return beginRead(i2cAddress, bufferLength) && _wait() && end(buffer);
+}
 
-bool DS28E17::memoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t *buffer, uint8_t bufferLength) 
+bool DS28E17::beginMemoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t bufferLength) 
 {
   uint8_t header[6];
   uint8_t headerLength;
@@ -203,5 +323,13 @@ bool DS28E17::memoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t *buff
     header[4] = bufferLength;         // number of bytes to be read
   }
 
-  return _readFrom(header, headerLength, buffer, bufferLength);    
+  pendingCommand = DS28E17_MEMMORY_READ;
+  pendingLength = bufferLength;
+
+  return _send(header, headerLength, NULL, 0);    
+}
+
+bool DS28E17::memoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t *buffer, uint8_t bufferLength) 
+{
+  return beginMemoryRead(i2cAddress, i2cRegister, bufferLength) && _wait() && end(buffer);
 }
\ No newline at end of file
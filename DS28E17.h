@@ -16,13 +16,34 @@ MIT License
 
 #include "Arduino.h"
 #include <OneWire.h>
+#include "OneWireBus.h"
 
 #define ONEWIRE_TIMEOUT 50
+#define DS28E17_BROADCAST_WAIT 2
 
 #define DS28E17_ENABLE_SLEEP 0x1E
 #define DS28E17_WRITE 0x4B
 #define DS28E17_READ 0x87
 #define DS28E17_MEMMORY_READ 0x2D
+#define DS28E17_READ_CONFIG 0xE1
+
+#define DS28E17_STATUS_CRC 0x01
+#define DS28E17_STATUS_ADDRESS_NACK 0x02
+#define DS28E17_STATUS_START 0x08
+
+/**
+ * @brief DS28E17 transaction error.
+ */
+typedef enum
+{
+    DS28E17_ERROR_NONE = 0,     //! @brief Transaction was successful
+    DS28E17_ERROR_PRESENCE,     //! @brief No presence pulse after 1-Wire reset
+    DS28E17_ERROR_TIMEOUT,      //! @brief DS28E17 was busy longer than ONEWIRE_TIMEOUT
+    DS28E17_ERROR_CRC,          //! @brief DS28E17 reported invalid CRC16 of the command
+    DS28E17_ERROR_ADDRESS_NACK, //! @brief I2C device did not acknowledge its address
+    DS28E17_ERROR_START,        //! @brief I2C start condition could not be generated
+    DS28E17_ERROR_WRITE_NACK    //! @brief I2C device did not acknowledge written data
+} ds28e17Error;
 
 class DS28E17
 {
@@ -37,6 +58,17 @@ class DS28E17
       */
     DS28E17(OneWire *oneWire);
     
+    /**
+      * @brief       Constructor of DS28E17 class using custom 1-Wire transport.
+      */
+    DS28E17(OneWireBus *oneWireBus);
+    
+    /**
+     * @brief       Get 1-Wire transport used by DS28E17.
+     * @return      Pointer to the 1-Wire transport.
+     */
+    OneWireBus *getBus();
+    
     /**
      * @brief       Set address of DS28E17.
      * @param[in]   sensorAddress   address of DS28E17
@@ -53,6 +85,17 @@ class DS28E17
      */    
     void enableSleepMode();
     
+    /**
+     * @brief       Put all DS28E17 on the bus into sleep mode by Skip ROM.
+     */    
+    void enableSleepModeAll();
+    
+    /**
+     * @brief       Check that DS28E17 with the set address answers on the bus.
+     * @return      True if the device answered, otherwise false.
+     */
+    bool verify();
+    
     /**
      * @brief       Write data to I2C device connected to DS28E17.
      * @param       i2cAddress    address of required I2C device
@@ -72,6 +115,16 @@ class DS28E17
      */
     bool memoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength);
     
+    /**
+     * @brief       Write data to specified register in I2C device connected to every DS28E17 on the bus by Skip ROM.
+     * @param       i2cAddress    address of required I2C device
+     * @param       i2cRegister   addres of required register in I2C device (may be 8 or 16 bit)
+     * @param[in]   data          data to be written
+     * @param       dataLength    length of written data
+     * @return      True if the command was sent, status of the devices is not checked.
+     */
+    bool memoryWriteAll(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength);
+    
     /**
      * @brief       Read data from I2C device connected to DS28E17.
      * @param       i2cAddress    address of required I2C device
@@ -91,11 +144,76 @@ class DS28E17
      */
     bool memoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t *buffer, uint8_t bufferLength); 
     
+    /**
+     * @brief       Start write to I2C device without waiting for DS28E17, finish it by end().
+     * @param       i2cAddress    address of required I2C device
+     * @param[in]   data          data to be written
+     * @param       dataLength    length of written data
+     * @return      True if the transaction was started, otherwise false.
+     */
+    bool beginWrite(uint8_t i2cAddress, uint8_t *data, uint8_t dataLength);
+    
+    /**
+     * @brief       Start write to register of I2C device without waiting for DS28E17, finish it by end().
+     * @param       i2cAddress    address of required I2C device
+     * @param       i2cRegister   addres of required register in I2C device (may be 8 or 16 bit)
+     * @param[in]   data          data to be written
+     * @param       dataLength    length of written data
+     * @return      True if the transaction was started, otherwise false.
+     */
+    bool beginMemoryWrite(uint8_t i2cAddress, uint8_t i2cRegister, uint8_t *data, uint8_t dataLength);
+    
+    /**
+     * @brief       Start read from I2C device without waiting for DS28E17, finish it by end().
+     * @param       i2cAddress    address of required I2C device
+     * @param       bufferLength  required data length
+     * @return      True if the transaction was started, otherwise false.
+     */
+    bool beginRead(uint8_t i2cAddress, uint8_t bufferLength);
+    
+    /**
+     * @brief       Start read from register of I2C device without waiting for DS28E17, finish it by end().
+     * @param       i2cAddress    address of required I2C device
+     * @param       i2cRegister   addres of required register in I2C device (may be 8 or 16 bit)
+     * @param       bufferLength  required data length
+     * @return      True if the transaction was started, otherwise false.
+     */
+    bool beginMemoryRead(uint8_t i2cAddress, uint16_t i2cRegister, uint8_t bufferLength);
+    
+    /**
+     * @brief       Poll if DS28E17 is still busy with the started transaction, the line is not touched while the transport has queued slots.
+     * @return      True if busy, otherwise false.
+     */
+    bool isBusy();
+    
+    /**
+     * @brief       Finish the started transaction after DS28E17 is not busy.
+     * @param[out]  buffer        buffer for readed data, may be NULL for writes
+     * @return      True if the transaction was successful, otherwise false.
+     */
+    bool end(uint8_t *buffer);
+    
+    /**
+     * @brief       Abandon the started transaction as timed out.
+     */
+    void abort();
+    
+    /**
+     * @brief       Get error of the last transaction.
+     * @return      Error of the last transaction, DS28E17_ERROR_NONE if it was successful.
+     */
+    ds28e17Error lastError();
+    
   private:
     /**
-     * @brief       Pointer to OneWire object.
+     * @brief       Transport wrapping OneWire object passed to the constructor.
      */
-    OneWire *oneWire;
+    OneWirePinBus pinBus;
+    
+    /**
+     * @brief       Pointer to custom transport, NULL if pinBus is used.
+     */
+    OneWireBus *bus;
     
     /**
      * @brief       DS28E17 address.
@@ -103,24 +221,48 @@ class DS28E17
     uint8_t *address;
     
     /**
-     * @brief       Common part for data write - compute CRC, send and read status.
+     * @brief       Error of the last transaction.
+     */
+    ds28e17Error error;
+    
+    /**
+     * @brief       Decode status bytes returned by DS28E17.
+     * @param       stat          status byte
+     * @param       writeStat     write status byte
+     * @return      Error corresponding to the status bytes.
+     */
+    ds28e17Error _decodeStatus(uint8_t stat, uint8_t writeStat);
+    
+    /**
+     * @brief       Command of the pending transaction.
+     */
+    uint8_t pendingCommand;
+    
+    /**
+     * @brief       Number of bytes to be read by the pending transaction.
+     */
+    uint8_t pendingLength;
+    
+    /**
+     * @brief       True if the command is sent to all devices by Skip ROM.
+     */
+    bool broadcast;
+    
+    /**
+     * @brief       Common part for transaction start - compute CRC and send command.
      * @param[in]   header        header to be write
      * @param       headerLength  header length
      * @param[in]   data          data to be write
      * @param       dataLength    data length
-     * @return      True if the write was successful, otherwise false.
+     * @return      True if the command was sent, otherwise false.
      */
-    bool _writeTo(uint8_t *header, uint8_t headerLength, uint8_t *data, uint8_t dataLength);
+    bool _send(uint8_t *header, uint8_t headerLength, uint8_t *data, uint8_t dataLength);
     
     /**
-     * @brief       Common part for data write - compute CRC, send and read status.
-     * @param[in]   header        header to be write
-     * @param       headerLength  header length
-     * @param[out]  buffer        buffer for readed data
-     * @param       bufferLength  required data length
-     * @return      True if the read was successful, otherwise false.
+     * @brief       Wait until DS28E17 finishes the pending transaction.
+     * @return      True if finished, false on timeout.
      */
-    bool _readFrom(uint8_t *header, uint8_t headerLength, uint8_t *buffer, uint8_t bufferLength);       
+    bool _wait();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+
+1-Wire Bus Transport
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+*/
+
+#include "Arduino.h"
+#include "OneWireBus.h"
+
+
+OneWirePinBus::OneWirePinBus()
+{
+  oneWire = NULL;
+}
+
+
+OneWirePinBus::OneWirePinBus(OneWire *oneWireW)
+{
+  oneWire = oneWireW;
+}
+
+
+uint8_t OneWirePinBus::reset()
+{
+  return oneWire->reset();
+}
+
+
+void OneWirePinBus::select(const uint8_t rom[8])
+{
+  oneWire->select(rom);
+}
+
+
+void OneWirePinBus::skip()
+{
+  oneWire->skip();
+}
+
+
+void OneWirePinBus::write(uint8_t v)
+{
+  oneWire->write(v, 0);
+}
+
+
+void OneWirePinBus::write_bytes(const uint8_t *buf, uint16_t count)
+{
+  oneWire->write_bytes(buf, count, 0);
+}
+
+
+uint8_t OneWirePinBus::read()
+{
+  return oneWire->read();
+}
+
+
+uint8_t OneWirePinBus::read_bit()
+{
+  return oneWire->read_bit();
+}
+
+
+void OneWirePinBus::depower()
+{
+  oneWire->depower();
+}
+
+
+void OneWirePinBus::reset_search()
+{
+  oneWire->reset_search();
+}
+
+
+void OneWirePinBus::target_search(uint8_t family)
+{
+  oneWire->target_search(family);
+}
+
+
+bool OneWirePinBus::search(uint8_t *rom)
+{
+  return oneWire->search(rom);
+}
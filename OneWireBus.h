@@ -0,0 +1,131 @@
+/*
+
+1-Wire Bus Transport
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+Interface of the 1-Wire transport used by DS28E17, so the bit-banged OneWire
+library can be wrapped (trace recording) or replaced (trace replay).
+
+MIT License
+
+*/
+#ifndef OneWireBus_h
+#define OneWireBus_h
+
+#include "Arduino.h"
+#include <OneWire.h>
+
+class OneWireBus
+{
+  public:
+    virtual ~OneWireBus() {}
+
+    /**
+     * @brief       Send reset pulse.
+     * @return      1 if a device asserted presence pulse, otherwise 0.
+     */
+    virtual uint8_t reset() = 0;
+    
+    /**
+     * @brief       Address device by Match ROM.
+     * @param[in]   rom   ROM of the device
+     */
+    virtual void select(const uint8_t rom[8]) = 0;
+    
+    /**
+     * @brief       Address all devices by Skip ROM.
+     */
+    virtual void skip() = 0;
+    
+    /**
+     * @brief       Write byte.
+     * @param       v     byte to be written
+     */
+    virtual void write(uint8_t v) = 0;
+    
+    /**
+     * @brief       Write bytes.
+     * @param[in]   buf   bytes to be written
+     * @param       count number of bytes
+     */
+    virtual void write_bytes(const uint8_t *buf, uint16_t count) = 0;
+    
+    /**
+     * @brief       Read byte.
+     * @return      Read byte.
+     */
+    virtual uint8_t read() = 0;
+    
+    /**
+     * @brief       Read single bit.
+     * @return      Read bit.
+     */
+    virtual uint8_t read_bit() = 0;
+    
+    /**
+     * @brief       Stop powering the bus after a strong pull-up.
+     */
+    virtual void depower() = 0;
+    
+    /**
+     * @brief       Restart ROM search.
+     */
+    virtual void reset_search() = 0;
+    
+    /**
+     * @brief       Restart ROM search limited to one family.
+     * @param       family    family code to be searched
+     */
+    virtual void target_search(uint8_t family) = 0;
+    
+    /**
+     * @brief       Find next device on the bus.
+     * @param[out]  rom   ROM of the found device
+     * @return      True if a device was found, otherwise false.
+     */
+    virtual bool search(uint8_t *rom) = 0;
+    
+    /**
+     * @brief       Check if all written slots are on the line, for transports which queue them.
+     * @return      True if idle, false while written slots are still queued.
+     */
+    virtual bool isIdle() { return true; }
+};
+
+class OneWirePinBus : public OneWireBus
+{
+  public:
+    /**
+     * @brief       Constructor of OneWirePinBus class.
+     */
+    OneWirePinBus();
+    
+    /**
+     * @brief       Constructor of OneWirePinBus class.
+     * @param       oneWire   bit-banged OneWire bus to be used
+     */
+    OneWirePinBus(OneWire *oneWire);
+    
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v);
+    void write_bytes(const uint8_t *buf, uint16_t count);
+    uint8_t read();
+    uint8_t read_bit();
+    void depower();
+    void reset_search();
+    void target_search(uint8_t family);
+    bool search(uint8_t *rom);
+    
+  private:
+    /**
+     * @brief       Pointer to OneWire object.
+     */
+    OneWire *oneWire;
+};
+
+#endif
@@ -0,0 +1,547 @@
+/*
+
+1-Wire Bus Trace
+================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+*/
+
+#include "Arduino.h"
+#include "OneWireTrace.h"
+
+
+OneWireTraceRecorder::OneWireTraceRecorder(OneWireBus *oneWireBus, oneWireTraceRecord *buffer, uint16_t capacity)
+{
+  bus = oneWireBus;
+  records = buffer;
+  recordsCapacity = capacity;
+  clear();
+}
+
+
+void OneWireTraceRecorder::clear()
+{
+  recordsHead = 0;
+  recordsLength = 0;
+  lastTime = micros();
+}
+
+
+uint16_t OneWireTraceRecorder::length()
+{
+  return recordsLength;
+}
+
+
+oneWireTraceRecord OneWireTraceRecorder::at(uint16_t index)
+{
+  uint16_t first = (recordsHead + recordsCapacity - recordsLength) % recordsCapacity;
+
+  return records[(first + index) % recordsCapacity];
+}
+
+
+void OneWireTraceRecorder::dump(Print &out)
+{
+  for (uint16_t i = 0; i < recordsLength; i++) {
+    oneWireTraceRecord record = at(i);
+    uint8_t data[4] = { record.op, record.value, (uint8_t) record.time, (uint8_t) (record.time >> 8) };
+    out.write(data, sizeof(data));
+  }
+}
+
+
+void OneWireTraceRecorder::_record(uint8_t op, uint8_t value)
+{
+  if (recordsCapacity == 0) {
+    return;
+  }
+
+  uint32_t now = micros();
+  uint32_t time = now - lastTime;
+  lastTime = now;
+
+  records[recordsHead].op = op;
+  records[recordsHead].value = value;
+  records[recordsHead].time = time > 0xFFFF ? 0xFFFF : time;
+
+  recordsHead = (recordsHead + 1) % recordsCapacity;
+  if (recordsLength < recordsCapacity) {
+    recordsLength++;
+  }
+}
+
+
+uint8_t OneWireTraceRecorder::reset()
+{
+  uint8_t presence = bus->reset();
+  _record(ONEWIRE_TRACE_RESET, presence);
+  return presence;
+}
+
+
+void OneWireTraceRecorder::select(const uint8_t rom[8])
+{
+  bus->select(rom);
+  _record(ONEWIRE_TRACE_SELECT, rom[7]);
+  for (uint8_t i = 0; i < 8; i++) {
+    _record(ONEWIRE_TRACE_SELECT_ROM, rom[i]);
+  }
+}
+
+
+void OneWireTraceRecorder::skip()
+{
+  bus->skip();
+  _record(ONEWIRE_TRACE_SKIP, 0);
+}
+
+
+void OneWireTraceRecorder::write(uint8_t v)
+{
+  bus->write(v);
+  _record(ONEWIRE_TRACE_WRITE, v);
+}
+
+
+void OneWireTraceRecorder::write_bytes(const uint8_t *buf, uint16_t count)
+{
+  for (uint16_t i = 0; i < count; i++) {
+    write(buf[i]);
+  }
+}
+
+
+uint8_t OneWireTraceRecorder::read()
+{
+  uint8_t v = bus->read();
+  _record(ONEWIRE_TRACE_READ, v);
+  return v;
+}
+
+
+bool OneWireTraceRecorder::isIdle()
+{
+  return bus->isIdle();
+}
+
+
+uint8_t OneWireTraceRecorder::read_bit()
+{
+  uint8_t v = bus->read_bit();
+  _record(ONEWIRE_TRACE_READ_BIT, v);
+  return v;
+}
+
+
+void OneWireTraceRecorder::depower()
+{
+  bus->depower();
+  _record(ONEWIRE_TRACE_DEPOWER, 0);
+}
+
+
+void OneWireTraceRecorder::reset_search()
+{
+  bus->reset_search();
+  _record(ONEWIRE_TRACE_RESET_SEARCH, 0);
+}
+
+
+void OneWireTraceRecorder::target_search(uint8_t family)
+{
+  bus->target_search(family);
+  _record(ONEWIRE_TRACE_TARGET_SEARCH, family);
+}
+
+
+bool OneWireTraceRecorder::search(uint8_t *rom)
+{
+  bool found = bus->search(rom);
+  _record(ONEWIRE_TRACE_SEARCH, found);
+  if (found) {
+    for (uint8_t i = 0; i < 8; i++) {
+      _record(ONEWIRE_TRACE_SEARCH_ROM, rom[i]);
+    }
+  }
+  return found;
+}
+
+
+// Timing of the OneWire library for operations missing in the trace
+static const uint16_t defaultTime[ONEWIRE_TRACE_SELECT_ROM + 1] = {
+  0,      // unused
+  960,    // reset
+  5040,   // select, command and ROM
+  560,    // skip
+  560,    // write
+  560,    // read
+  70,     // read bit
+  0,      // depower
+  0,      // reset search
+  0,      // target search
+  14320,  // search, reset, command and 3 slots for each ROM bit
+  0,      // search ROM, part of search
+  0       // select ROM, part of select
+};
+
+
+OneWireTraceReplay::OneWireTraceReplay(const oneWireTraceRecord *buffer, uint16_t length)
+{
+  records = buffer;
+  recordsLength = length;
+  presence = 0;
+
+  for (uint8_t op = 0; op <= ONEWIRE_TRACE_SELECT_ROM; op++) {
+    operationTime[op] = 0xFFFF;
+  }
+
+  // The shortest recorded time is the operation itself without the driver around it
+  for (uint16_t i = 0; i < recordsLength; i++) {
+    uint8_t op = records[i].op;
+    if ((op <= ONEWIRE_TRACE_SELECT_ROM) && (records[i].time < operationTime[op])) {
+      operationTime[op] = records[i].time;
+    }
+    if ((op == ONEWIRE_TRACE_RESET) && records[i].value) {
+      presence = records[i].value;
+    }
+  }
+
+  for (uint8_t op = 0; op <= ONEWIRE_TRACE_SELECT_ROM; op++) {
+    if (operationTime[op] == 0xFFFF) {
+      operationTime[op] = defaultTime[op];
+    }
+  }
+
+  rewind();
+}
+
+
+uint16_t OneWireTraceReplay::load(const uint8_t *data, size_t size, oneWireTraceRecord *buffer, uint16_t length)
+{
+  uint16_t count = 0;
+
+  while ((count < length) && ((size_t) (count + 1) * 4 <= size)) {
+    const uint8_t *p = &data[count * 4];
+    buffer[count].op = p[0];
+    buffer[count].value = p[1];
+    buffer[count].time = p[2] | p[3] << 8;
+    count++;
+  }
+
+  return count;
+}
+
+
+void OneWireTraceReplay::rewind()
+{
+  clock = 0;
+  lastMicros = micros();
+  operationsCount = 0;
+  selectOp = 0;
+  memset(selectRom, 0, sizeof(selectRom));
+  selected = false;
+  requestLength = 0;
+  resolved = false;
+  responsePosition = 0;
+  busyStart = 0;
+  busyTime = 0;
+  matchPosition = 0;
+  searchFamily = 0;
+  searchCount = 0;
+  mismatch = false;
+}
+
+
+uint32_t OneWireTraceReplay::operations()
+{
+  return operationsCount;
+}
+
+
+uint32_t OneWireTraceReplay::elapsed()
+{
+  return clock;
+}
+
+
+bool OneWireTraceReplay::diverged()
+{
+  return mismatch;
+}
+
+
+void OneWireTraceReplay::_advance(uint8_t op)
+{
+  uint32_t now = micros();
+  clock += now - lastMicros + operationTime[op];
+  lastMicros = now;
+  operationsCount++;
+}
+
+
+bool OneWireTraceReplay::_selects(uint16_t index)
+{
+  if ((records[index].op != ONEWIRE_TRACE_SELECT) || (records[index].value != selectRom[7])) {
+    return false;
+  }
+
+  // Trace recorded before select ROM records has only the CRC byte
+  for (uint8_t i = 0; i < 8; i++) {
+    index++;
+    if ((index >= recordsLength) || (records[index].op != ONEWIRE_TRACE_SELECT_ROM)) {
+      return i == 0;
+    }
+    if (records[index].value != selectRom[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+uint16_t OneWireTraceReplay::_afterSelect(uint16_t index)
+{
+  index++;
+  while ((index < recordsLength) && (records[index].op == ONEWIRE_TRACE_SELECT_ROM)) {
+    index++;
+  }
+  return index;
+}
+
+
+bool OneWireTraceReplay::_matches(uint16_t index)
+{
+  if ((records[index].op != selectOp) || ((selectOp == ONEWIRE_TRACE_SELECT) && !_selects(index))) {
+    return false;
+  }
+
+  index = _afterSelect(index);
+
+  for (uint8_t i = 0; i < requestLength; i++) {
+    if ((index >= recordsLength) || (records[index].op != ONEWIRE_TRACE_WRITE) || (records[index].value != request[i])) {
+      return false;
+    }
+    index++;
+  }
+
+  // Longer recorded request is another one
+  return (index >= recordsLength) || (records[index].op != ONEWIRE_TRACE_WRITE);
+}
+
+
+void OneWireTraceReplay::_resolve()
+{
+  resolved = true;
+  busyStart = clock;
+  busyTime = 0;
+  responsePosition = recordsLength;
+
+  // Repeated requests get their recorded responses in order
+  for (uint16_t n = 0; n < recordsLength; n++) {
+    uint16_t index = (matchPosition + n) % recordsLength;
+
+    if (!_matches(index)) {
+      continue;
+    }
+
+    responsePosition = _afterSelect(index) + requestLength;
+    matchPosition = responsePosition % recordsLength;
+
+    // Device got ready between the last poll which found it busy and the first one which found it ready
+    uint32_t time = 0;
+    uint32_t busy = 0;
+    for (uint16_t i = responsePosition; i < recordsLength; i++) {
+      if (records[i].op != ONEWIRE_TRACE_READ_BIT) {
+        break;
+      }
+      time += records[i].time;
+      busyTime = 0xFFFFFFFF;
+      if (records[i].value == 0) {
+        busyTime = (busy + time - operationTime[ONEWIRE_TRACE_READ_BIT]) / 2;
+        break;
+      }
+      busy = time;
+    }
+    return;
+  }
+
+  // Reads of an unknown request fail fast by all ones
+  mismatch = true;
+}
+
+
+bool OneWireTraceReplay::_searchRom(uint16_t index, uint8_t *rom)
+{
+  if ((records[index].op != ONEWIRE_TRACE_SEARCH) || !records[index].value || (index + 8 >= recordsLength)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < 8; i++) {
+    if (records[index + 1 + i].op != ONEWIRE_TRACE_SEARCH_ROM) {
+      return false;
+    }
+    rom[i] = records[index + 1 + i].value;
+  }
+
+  return true;
+}
+
+
+uint8_t OneWireTraceReplay::reset()
+{
+  selectOp = 0;
+  selected = false;
+  requestLength = 0;
+  resolved = false;
+  _advance(ONEWIRE_TRACE_RESET);
+  return presence;
+}
+
+
+void OneWireTraceReplay::select(const uint8_t rom[8])
+{
+  selectOp = ONEWIRE_TRACE_SELECT;
+  memcpy(selectRom, rom, sizeof(selectRom));
+  selected = false;
+
+  // Device which was never selected in the trace does not answer
+  for (uint16_t i = 0; i < recordsLength; i++) {
+    if (_selects(i)) {
+      selected = true;
+      break;
+    }
+  }
+
+  _advance(ONEWIRE_TRACE_SELECT);
+}
+
+
+void OneWireTraceReplay::skip()
+{
+  selectOp = ONEWIRE_TRACE_SKIP;
+  selected = presence != 0;
+  _advance(ONEWIRE_TRACE_SKIP);
+}
+
+
+void OneWireTraceReplay::write(uint8_t v)
+{
+  if (selected && !resolved) {
+    if (requestLength < ONEWIRE_TRACE_REQUEST_MAX) {
+      request[requestLength++] = v;
+    }
+    else {
+      mismatch = true;
+    }
+  }
+  _advance(ONEWIRE_TRACE_WRITE);
+}
+
+
+void OneWireTraceReplay::write_bytes(const uint8_t *buf, uint16_t count)
+{
+  for (uint16_t i = 0; i < count; i++) {
+    write(buf[i]);
+  }
+}
+
+
+uint8_t OneWireTraceReplay::read()
+{
+  uint8_t v = 0xFF;
+
+  if (selected) {
+    if (!resolved) {
+      _resolve();
+    }
+    // Next recorded read of the transaction, polls and depower are skipped
+    while (responsePosition < recordsLength) {
+      const oneWireTraceRecord *record = &records[responsePosition];
+      if ((record->op == ONEWIRE_TRACE_RESET) || (record->op == ONEWIRE_TRACE_SELECT) || (record->op == ONEWIRE_TRACE_SKIP)) {
+        break;
+      }
+      responsePosition++;
+      if (record->op == ONEWIRE_TRACE_READ) {
+        v = record->value;
+        break;
+      }
+    }
+  }
+
+  _advance(ONEWIRE_TRACE_READ);
+  return v;
+}
+
+
+uint8_t OneWireTraceReplay::read_bit()
+{
+  if (selected && !resolved) {
+    _resolve();
+  }
+
+  _advance(ONEWIRE_TRACE_READ_BIT);
+
+  if (!selected) {
+    return 1;
+  }
+
+  return clock - operationTime[ONEWIRE_TRACE_READ_BIT] - busyStart < busyTime ? 1 : 0;
+}
+
+
+void OneWireTraceReplay::depower()
+{
+  _advance(ONEWIRE_TRACE_DEPOWER);
+}
+
+
+void OneWireTraceReplay::reset_search()
+{
+  searchFamily = 0;
+  searchCount = 0;
+  _advance(ONEWIRE_TRACE_RESET_SEARCH);
+}
+
+
+void OneWireTraceReplay::target_search(uint8_t family)
+{
+  searchFamily = family;
+  searchCount = 0;
+  _advance(ONEWIRE_TRACE_TARGET_SEARCH);
+}
+
+
+bool OneWireTraceReplay::search(uint8_t *rom)
+{
+  uint8_t candidate[8];
+  uint8_t previous[8];
+  uint16_t found = 0;
+  bool result = false;
+
+  // Every recorded ROM is found once, in order of its first search
+  for (uint16_t i = 0; (i < recordsLength) && !result; i++) {
+    if (!_searchRom(i, candidate) || ((searchFamily != 0) && (candidate[0] != searchFamily))) {
+      continue;
+    }
+
+    bool seen = false;
+    for (uint16_t j = 0; (j < i) && !seen; j++) {
+      seen = _searchRom(j, previous) && (memcmp(previous, candidate, sizeof(candidate)) == 0);
+    }
+
+    if (!seen && (found++ == searchCount)) {
+      memcpy(rom, candidate, sizeof(candidate));
+      searchCount++;
+      result = true;
+    }
+  }
+
+  _advance(ONEWIRE_TRACE_SEARCH);
+  return result;
+}
@@ -0,0 +1,281 @@
+/*
+
+1-Wire Bus Trace
+================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+Recorder which logs every 1-Wire operation with its timing into a ring buffer,
+and replay transport which answers DS28E17 requests by responses recorded per
+transaction, so that a changed driver can be replayed and timed on a PC. Select
+and search are followed by records of the whole ROM, so devices are told apart
+even if their ROMs end with the same CRC byte.
+
+MIT License
+
+*/
+#ifndef OneWireTrace_h
+#define OneWireTrace_h
+
+#include "Arduino.h"
+#include "OneWireBus.h"
+
+#define ONEWIRE_TRACE_RESET 0x01
+#define ONEWIRE_TRACE_SELECT 0x02
+#define ONEWIRE_TRACE_SKIP 0x03
+#define ONEWIRE_TRACE_WRITE 0x04
+#define ONEWIRE_TRACE_READ 0x05
+#define ONEWIRE_TRACE_READ_BIT 0x06
+#define ONEWIRE_TRACE_DEPOWER 0x07
+#define ONEWIRE_TRACE_RESET_SEARCH 0x08
+#define ONEWIRE_TRACE_TARGET_SEARCH 0x09
+#define ONEWIRE_TRACE_SEARCH 0x0A
+#define ONEWIRE_TRACE_SEARCH_ROM 0x0B
+#define ONEWIRE_TRACE_SELECT_ROM 0x0C
+
+#define ONEWIRE_TRACE_REQUEST_MAX 32
+
+/**
+ * @brief 1-Wire trace record, dumped as 4 bytes with little endian time.
+ */
+typedef struct
+{
+    uint8_t op;     //! @brief Operation ONEWIRE_TRACE_*
+    uint8_t value;  //! @brief Written or read value, CRC byte of ROM for select, ROM byte for search and select ROM
+    uint16_t time;  //! @brief Microseconds since the previous record, saturated
+} oneWireTraceRecord;
+
+class OneWireTraceRecorder : public OneWireBus
+{
+  public:
+    /**
+     * @brief       Constructor of OneWireTraceRecorder class.
+     * @param       oneWireBus  transport to be recorded
+     * @param[out]  buffer      ring buffer for records
+     * @param       capacity    number of records in buffer
+     */
+    OneWireTraceRecorder(OneWireBus *oneWireBus, oneWireTraceRecord *buffer, uint16_t capacity);
+    
+    /**
+     * @brief       Drop all records.
+     */
+    void clear();
+    
+    /**
+     * @brief       Get number of records, at most capacity.
+     * @return      Number of records.
+     */
+    uint16_t length();
+    
+    /**
+     * @brief       Get record, oldest first.
+     * @param       index   index of the record
+     * @return      Record.
+     */
+    oneWireTraceRecord at(uint16_t index);
+    
+    /**
+     * @brief       Write all records, oldest first, in binary form.
+     * @param       out     output such as Serial
+     */
+    void dump(Print &out);
+    
+    /**
+     * @brief       Check if the recorded transport is idle, not recorded.
+     * @return      True if idle, false while written slots are still queued.
+     */
+    bool isIdle();
+    
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v);
+    void write_bytes(const uint8_t *buf, uint16_t count);
+    uint8_t read();
+    uint8_t read_bit();
+    void depower();
+    void reset_search();
+    void target_search(uint8_t family);
+    bool search(uint8_t *rom);
+    
+  private:
+    /**
+     * @brief       Recorded transport.
+     */
+    OneWireBus *bus;
+    
+    /**
+     * @brief       Ring buffer for records.
+     */
+    oneWireTraceRecord *records;
+    uint16_t recordsCapacity;
+    uint16_t recordsHead;
+    uint16_t recordsLength;
+    
+    /**
+     * @brief       Time of the previous record in microseconds.
+     */
+    uint32_t lastTime;
+    
+    /**
+     * @brief       Append record, the oldest one is overwritten if the buffer is full.
+     * @param       op      operation
+     * @param       value   operation value
+     */
+    void _record(uint8_t op, uint8_t value);
+};
+
+class OneWireTraceReplay : public OneWireBus
+{
+  public:
+    /**
+     * @brief       Constructor of OneWireTraceReplay class.
+     * @param[in]   buffer  recorded trace, oldest first
+     * @param       length  number of records
+     */
+    OneWireTraceReplay(const oneWireTraceRecord *buffer, uint16_t length);
+    
+    /**
+     * @brief       Load trace from its binary dump.
+     * @param[in]   data    dumped trace
+     * @param       size    size of the dump in bytes
+     * @param[out]  buffer  buffer for records
+     * @param       length  number of records in buffer
+     * @return      Number of loaded records.
+     */
+    static uint16_t load(const uint8_t *data, size_t size, oneWireTraceRecord *buffer, uint16_t length);
+    
+    /**
+     * @brief       Start the replay from the beginning.
+     */
+    void rewind();
+    
+    /**
+     * @brief       Get number of bus operations since rewind.
+     * @return      Number of operations.
+     */
+    uint32_t operations();
+    
+    /**
+     * @brief       Get modeled time since rewind, operations take their shortest recorded time,
+     *              DS28E17 stays busy until midway between its recorded busy and ready polls
+     *              and time of the driver between operations is added.
+     * @return      Time in microseconds.
+     */
+    uint32_t elapsed();
+    
+    /**
+     * @brief       Check if the driver sent a request without recorded response.
+     * @return      True if the replay is not backed by the trace, otherwise false.
+     */
+    bool diverged();
+    
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v);
+    void write_bytes(const uint8_t *buf, uint16_t count);
+    uint8_t read();
+    uint8_t read_bit();
+    void depower();
+    void reset_search();
+    void target_search(uint8_t family);
+    bool search(uint8_t *rom);
+    
+  private:
+    /**
+     * @brief       Replayed trace.
+     */
+    const oneWireTraceRecord *records;
+    uint16_t recordsLength;
+    
+    /**
+     * @brief       Modeled time of every operation in microseconds.
+     */
+    uint16_t operationTime[ONEWIRE_TRACE_SELECT_ROM + 1];
+    
+    /**
+     * @brief       Presence answered by the recorded resets.
+     */
+    uint8_t presence;
+    
+    /**
+     * @brief       Modeled time, micros() of the previous operation and number of operations.
+     */
+    uint32_t clock;
+    uint32_t lastMicros;
+    uint32_t operationsCount;
+    
+    /**
+     * @brief       Current transaction, opened by select or skip after reset.
+     */
+    uint8_t selectOp;
+    uint8_t selectRom[8];
+    bool selected;
+    uint8_t request[ONEWIRE_TRACE_REQUEST_MAX];
+    uint8_t requestLength;
+    bool resolved;
+    uint16_t responsePosition;
+    uint32_t busyStart;
+    uint32_t busyTime;
+    
+    /**
+     * @brief       Record after the last matched transaction, matching continues from it.
+     */
+    uint16_t matchPosition;
+    
+    /**
+     * @brief       Search state, family filter and number of returned ROMs.
+     */
+    uint8_t searchFamily;
+    uint16_t searchCount;
+    
+    /**
+     * @brief       True after a request without recorded response.
+     */
+    bool mismatch;
+    
+    /**
+     * @brief       Advance modeled time by the time of the driver since the previous operation and the operation.
+     * @param       op      operation
+     */
+    void _advance(uint8_t op);
+    
+    /**
+     * @brief       Find recorded transaction with the same selection and request, start its response.
+     */
+    void _resolve();
+    
+    /**
+     * @brief       Check if the record at index selects the currently selected ROM,
+     *              only by the CRC byte in a trace without select ROM records.
+     * @param       index   index of select record
+     * @return      True if it selects the ROM, otherwise false.
+     */
+    bool _selects(uint16_t index);
+    
+    /**
+     * @brief       Skip select ROM records after a select or skip record.
+     * @param       index   index of select or skip record
+     * @return      Index of the first record after the selection.
+     */
+    uint16_t _afterSelect(uint16_t index);
+    
+    /**
+     * @brief       Check if the recorded transaction at index matches the current one.
+     * @param       index   index of select or skip record
+     * @return      True if it matches, otherwise false.
+     */
+    bool _matches(uint16_t index);
+    
+    /**
+     * @brief       Get recorded ROM of a successful search.
+     * @param       index   index of search record
+     * @param[out]  rom     recorded ROM
+     * @return      True if the record is a successful search, otherwise false.
+     */
+    bool _searchRom(uint16_t index, uint8_t *rom);
+};
+
+#endif
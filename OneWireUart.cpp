@@ -0,0 +1,255 @@
+/*
+
+1-Wire Bus over UART
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+*/
+
+#include "Arduino.h"
+#include "OneWireUart.h"
+
+
+OneWireUartBus::OneWireUartBus(HardwareSerial *serial)
+{
+  uart = serial;
+  queueHead = 0;
+  queueLength = 0;
+  queueBit = 0;
+  inFlight = 0;
+  echoTime = 0;
+  reset_search();
+}
+
+
+void OneWireUartBus::begin()
+{
+  uart->begin(ONEWIRE_UART_DATA_BAUD);
+  queueLength = 0;
+  queueBit = 0;
+  inFlight = 0;
+}
+
+
+bool OneWireUartBus::isIdle()
+{
+  // Echoes of written slots carry nothing, they only make room for more slots
+  while ((inFlight > 0) && (uart->available() > 0)) {
+    uart->read();
+    inFlight--;
+    echoTime = millis();
+  }
+
+  if ((inFlight > 0) && ((uint32_t) (millis() - echoTime) > ONEWIRE_UART_TIMEOUT)) {
+    // Line is not looped back, nothing more will come
+    queueLength = 0;
+    queueBit = 0;
+    inFlight = 0;
+  }
+
+  while ((queueLength > 0) && (inFlight < ONEWIRE_UART_IN_FLIGHT) && (uart->availableForWrite() > 0)) {
+    if (inFlight == 0) {
+      echoTime = millis();
+    }
+    uart->write(((queue[queueHead] >> queueBit) & 0x01) ? ONEWIRE_UART_BIT_1 : ONEWIRE_UART_BIT_0);
+    inFlight++;
+
+    if (++queueBit == 8) {
+      queueBit = 0;
+      queueHead = (queueHead + 1) % ONEWIRE_UART_QUEUE;
+      queueLength--;
+    }
+  }
+
+  return (queueLength == 0) && (inFlight == 0);
+}
+
+
+void OneWireUartBus::_setBaud(uint32_t baud)
+{
+  uart->flush();
+  uart->begin(baud);
+}
+
+
+int OneWireUartBus::_echo()
+{
+  uint32_t start = millis();
+  while (uart->available() == 0) {
+    if ((uint32_t) (millis() - start) > ONEWIRE_UART_TIMEOUT) {
+      return -1;
+    }
+  }
+  return uart->read();
+}
+
+
+void OneWireUartBus::_flush()
+{
+  while (!isIdle()) {
+  }
+}
+
+
+uint8_t OneWireUartBus::_bit(uint8_t v)
+{
+  _flush();
+  uart->write(v ? ONEWIRE_UART_BIT_1 : ONEWIRE_UART_BIT_0);
+  // A slave pulls the line low during the slot to send 0
+  return _echo() == ONEWIRE_UART_BIT_1;
+}
+
+
+uint8_t OneWireUartBus::reset()
+{
+  _flush();
+  _setBaud(ONEWIRE_UART_RESET_BAUD);
+  uart->write(ONEWIRE_UART_RESET);
+  int echo = _echo();
+  _setBaud(ONEWIRE_UART_DATA_BAUD);
+
+  // Presence pulse shortens the high part of the echoed reset
+  return (echo >= 0) && (echo != ONEWIRE_UART_RESET);
+}
+
+
+void OneWireUartBus::select(const uint8_t rom[8])
+{
+  write(0x55);
+  write_bytes(rom, 8);
+}
+
+
+void OneWireUartBus::skip()
+{
+  write(0xCC);
+}
+
+
+void OneWireUartBus::write(uint8_t v)
+{
+  // Only a write longer than the queue waits, for the slots of its first bytes
+  while (queueLength == ONEWIRE_UART_QUEUE) {
+    isIdle();
+  }
+
+  queue[(queueHead + queueLength) % ONEWIRE_UART_QUEUE] = v;
+  queueLength++;
+  isIdle();
+}
+
+
+void OneWireUartBus::write_bytes(const uint8_t *buf, uint16_t count)
+{
+  for (uint16_t i = 0; i < count; i++) {
+    write(buf[i]);
+  }
+}
+
+
+uint8_t OneWireUartBus::read()
+{
+  _flush();
+
+  for (uint8_t i = 0; i < 8; i++) {
+    uart->write(ONEWIRE_UART_BIT_1);
+  }
+
+  uint8_t v = 0;
+  for (uint8_t mask = 0x01; mask; mask <<= 1) {
+    if (_echo() == ONEWIRE_UART_BIT_1) {
+      v |= mask;
+    }
+  }
+  return v;
+}
+
+
+uint8_t OneWireUartBus::read_bit()
+{
+  return _bit(1);
+}
+
+
+void OneWireUartBus::depower()
+{
+  // UART never drives strong pull-up
+}
+
+
+void OneWireUartBus::reset_search()
+{
+  memset(searchRom, 0, sizeof(searchRom));
+  lastDiscrepancy = 0;
+  lastDevice = false;
+}
+
+
+void OneWireUartBus::target_search(uint8_t family)
+{
+  memset(searchRom, 0, sizeof(searchRom));
+  searchRom[0] = family;
+  lastDiscrepancy = 64;
+  lastDevice = false;
+}
+
+
+bool OneWireUartBus::search(uint8_t *rom)
+{
+  if (lastDevice || !reset()) {
+    reset_search();
+    return false;
+  }
+
+  write(0xF0);
+
+  uint8_t lastZero = 0;
+
+  for (uint8_t bit = 1; bit <= 64; bit++) {
+    uint8_t *p = &searchRom[(bit - 1) / 8];
+    uint8_t mask = 1 << ((bit - 1) % 8);
+
+    uint8_t idBit = _bit(1);
+    uint8_t cmpIdBit = _bit(1);
+    uint8_t direction;
+
+    if (idBit && cmpIdBit) {
+      reset_search();
+      return false;
+    }
+
+    if (idBit != cmpIdBit) {
+      direction = idBit;
+    }
+    else {
+      direction = bit < lastDiscrepancy ? (*p & mask) != 0 : bit == lastDiscrepancy;
+      if (!direction) {
+        lastZero = bit;
+      }
+    }
+
+    if (direction) {
+      *p |= mask;
+    }
+    else {
+      *p &= ~mask;
+    }
+
+    _bit(direction);
+  }
+
+  lastDiscrepancy = lastZero;
+  lastDevice = lastDiscrepancy == 0;
+
+  if (OneWire::crc8(searchRom, 7) != searchRom[7]) {
+    reset_search();
+    return false;
+  }
+
+  memcpy(rom, searchRom, 8);
+  return true;
+}
@@ -0,0 +1,128 @@
+/*
+
+1-Wire Bus over UART
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+1-Wire transport generating reset and bit slots by UART, one UART byte per slot.
+TX and RX are joined to the 1-Wire line through an open-drain driver (e.g. TX
+through a Schottky diode or an N-MOSFET) with the usual 4k7 pull-up.
+
+Written bytes are queued and return at once. Their slots are passed to the
+interrupt driven serial buffer at most ONEWIRE_UART_IN_FLIGHT at a time, so
+the echoes always fit the receive buffer. isIdle() consumes the echoes which
+arrived and passes more slots without waiting. DS28E17::isBusy() calls it
+instead of reading the busy bit while slots are queued, so startMeasurement()
+and process() send a transaction in the background. Only reset(), read(),
+read_bit() and search() wait, because they return what the line answered: for
+the queued slots and their own.
+
+MIT License
+
+*/
+#ifndef OneWireUart_h
+#define OneWireUart_h
+
+#include "Arduino.h"
+#include "OneWireBus.h"
+
+#define ONEWIRE_UART_RESET_BAUD 9600
+#define ONEWIRE_UART_DATA_BAUD 115200
+#define ONEWIRE_UART_RESET 0xF0
+#define ONEWIRE_UART_BIT_0 0x00
+#define ONEWIRE_UART_BIT_1 0xFF
+#define ONEWIRE_UART_QUEUE 32
+#define ONEWIRE_UART_IN_FLIGHT 32
+#define ONEWIRE_UART_TIMEOUT 10
+
+class OneWireUartBus : public OneWireBus
+{
+  public:
+    /**
+     * @brief       Constructor of OneWireUartBus class.
+     * @param       serial    UART wired to the 1-Wire line
+     */
+    OneWireUartBus(HardwareSerial *serial);
+    
+    /**
+     * @brief       Init UART.
+     */
+    void begin();
+    
+    /**
+     * @brief       Consume received echoes and transmit more queued slots, never waits.
+     * @return      True if idle, false while slots are being transmitted.
+     */
+    bool isIdle();
+    
+    uint8_t reset();
+    void select(const uint8_t rom[8]);
+    void skip();
+    void write(uint8_t v);
+    void write_bytes(const uint8_t *buf, uint16_t count);
+    uint8_t read();
+    uint8_t read_bit();
+    void depower();
+    void reset_search();
+    void target_search(uint8_t family);
+    bool search(uint8_t *rom);
+    
+  private:
+    /**
+     * @brief       Pointer to UART object.
+     */
+    HardwareSerial *uart;
+    
+    /**
+     * @brief       Written bytes whose slots were not all transmitted yet.
+     */
+    uint8_t queue[ONEWIRE_UART_QUEUE];
+    uint8_t queueHead;
+    uint8_t queueLength;
+    uint8_t queueBit;
+    
+    /**
+     * @brief       Number of transmitted slots whose echo was not read yet.
+     */
+    uint8_t inFlight;
+    
+    /**
+     * @brief       Time of the last received echo in milliseconds.
+     */
+    uint32_t echoTime;
+    
+    /**
+     * @brief       State of ROM search.
+     */
+    uint8_t searchRom[8];
+    uint8_t lastDiscrepancy;
+    bool lastDevice;
+    
+    /**
+     * @brief       Change UART baud rate after the transmission is finished.
+     * @param       baud    baud rate
+     */
+    void _setBaud(uint32_t baud);
+    
+    /**
+     * @brief       Wait for echo of a slot.
+     * @return      Echoed byte, -1 on timeout.
+     */
+    int _echo();
+    
+    /**
+     * @brief       Wait until all queued slots were transmitted.
+     */
+    void _flush();
+    
+    /**
+     * @brief       Transmit one slot and wait for it.
+     * @param       v       bit to be written, 1 for read slot
+     * @return      Read bit.
+     */
+    uint8_t _bit(uint8_t v);
+};
+
+#endif
@@ -3,17 +3,50 @@
 
 SoilSensor::SoilSensor(OneWire *ow)
 {
-    oneWire = ow;
     ds28e17 = DS28E17(ow);
+    error = SOIL_SENSOR_ERROR_NONE;
+    memset(healthScore, SOIL_SENSOR_HEALTH_MAX, sizeof(healthScore));
+    memset(failures, 0, sizeof(failures));
+    quarantineStart = 0;
+    quarantineTime = 0;
+    state = SOIL_SENSOR_STATE_IDLE;
+    stateTime = 0;
+    measuredMoisture = 0;
+    measuredTemperature = 0;
+    finishedChannel = SOIL_SENSOR_CHANNEL_MOISTURE;
+    memset(calibratedAddress, 0, sizeof(calibratedAddress));
+    swapped = false;
+}
+
+SoilSensor::SoilSensor(OneWireBus *bus)
+{
+    ds28e17 = DS28E17(bus);
+    error = SOIL_SENSOR_ERROR_NONE;
+    memset(healthScore, SOIL_SENSOR_HEALTH_MAX, sizeof(healthScore));
+    memset(failures, 0, sizeof(failures));
+    quarantineStart = 0;
+    quarantineTime = 0;
+    state = SOIL_SENSOR_STATE_IDLE;
+    stateTime = 0;
+    measuredMoisture = 0;
+    measuredTemperature = 0;
+    finishedChannel = SOIL_SENSOR_CHANNEL_MOISTURE;
+    memset(calibratedAddress, 0, sizeof(calibratedAddress));
+    swapped = false;
 }
 
 bool SoilSensor::begin()
 {
+    OneWireBus *oneWire = ds28e17.getBus();
+    uint8_t previous[8];
+
+    memcpy(previous, sensor.address, sizeof(previous));
+
     oneWire->reset();
     oneWire->reset();
 
     oneWire->reset_search();
-    oneWire->target_search(0x19);
+    oneWire->target_search(DS28E17_FAMILY);
 
     int timeout = 0;
 
@@ -38,21 +71,144 @@ bool SoilSensor::begin()
 
     ds28e17.setAddress(sensor.address);
 
-    _EEPROMLoad();
+    static const uint8_t none[8] = { 0 };
 
-    _TMP112EnableShutdownMode();
+    swapped = (memcmp(calibratedAddress, none, sizeof(none)) != 0) &&
+              (memcmp(calibratedAddress, sensor.address, sizeof(sensor.address)) != 0);
+
+    _attach(previous);
+
+    return true;
+}
+
+bool SoilSensor::begin(const uint8_t rom[8])
+{
+    uint8_t stored[8];
+    uint8_t previous[8];
+
+    // rom may be sensor.address itself
+    memcpy(stored, rom, sizeof(stored));
+    memcpy(previous, sensor.address, sizeof(previous));
+    memcpy(sensor.address, stored, sizeof(sensor.address));
+
+    ds28e17.setAddress(sensor.address);
+
+    if ((stored[0] != DS28E17_FAMILY) || !ds28e17.verify())
+    {
+        if (!_search(stored))
+        {
+            memset(sensor.address, 0, sizeof(sensor.address));
+
+            return false;
+        }
+    }
+
+    swapped = memcmp(sensor.address, stored, sizeof(stored)) != 0;
+
+    _attach(previous);
 
     return true;
 }
 
+bool SoilSensor::_search(const uint8_t rom[8])
+{
+    OneWireBus *oneWire = ds28e17.getBus();
+    uint8_t address[8];
+    uint8_t found = 0;
+
+    // Single family-targeted pass instead of SEARCH_TIMEOUT rounds
+    oneWire->reset_search();
+    oneWire->target_search(DS28E17_FAMILY);
+
+    while (oneWire->search(address) && (address[0] == DS28E17_FAMILY))
+    {
+        if (OneWire::crc8(address, 7) != address[7])
+        {
+            continue;
+        }
+
+        if (memcmp(address, rom, sizeof(address)) == 0)
+        {
+            memcpy(sensor.address, address, sizeof(address));
+
+            return true;
+        }
+
+        // On a shared bus another sensor may belong to another SoilSensor, so adopt it only if it is alone
+        if (found++ == 0)
+        {
+            memcpy(sensor.address, address, sizeof(address));
+        }
+    }
+
+    return found == 1;
+}
+
+bool SoilSensor::begin(const uint8_t rom[8], const soilSensorEeprom *calibration)
+{
+    // Calibration saved with the ROM is used unless another sensor is found
+    memcpy(&sensor.eeprom, calibration, sizeof(soilSensorEeprom));
+    memcpy(calibratedAddress, rom, sizeof(calibratedAddress));
+
+    return begin(rom);
+}
+
+void SoilSensor::getCalibration(soilSensorEeprom *calibration)
+{
+    memcpy(calibration, &sensor.eeprom, sizeof(soilSensorEeprom));
+}
+
+void SoilSensor::getAddress(uint8_t rom[8])
+{
+    memcpy(rom, sensor.address, sizeof(sensor.address));
+}
+
+bool SoilSensor::isSwapped()
+{
+    return swapped;
+}
+
+void SoilSensor::_attach(const uint8_t previous[8])
+{
+    // Failures of a replaced probe would keep the new one quarantined
+    if (swapped || (memcmp(previous, sensor.address, sizeof(sensor.address)) != 0))
+    {
+        error = SOIL_SENSOR_ERROR_NONE;
+        memset(healthScore, SOIL_SENSOR_HEALTH_MAX, sizeof(healthScore));
+        memset(failures, 0, sizeof(failures));
+        quarantineStart = 0;
+        quarantineTime = 0;
+        state = SOIL_SENSOR_STATE_IDLE;
+    }
+
+    // Calibration is read only once per sensor, or never if it was handed back by begin(rom, calibration)
+    if (memcmp(calibratedAddress, sensor.address, sizeof(sensor.address)) != 0)
+    {
+        bool loaded = _EEPROMLoad();
+        ds28e17Error loadError = ds28e17.lastError();
+
+        // Missing or blank EEPROM stays so, a bus error may be gone on the next begin
+        if (loaded || (loadError == DS28E17_ERROR_NONE) || (loadError == DS28E17_ERROR_ADDRESS_NACK))
+        {
+            memcpy(calibratedAddress, sensor.address, sizeof(sensor.address));
+        }
+        else
+        {
+            memset(calibratedAddress, 0, sizeof(calibratedAddress));
+        }
+    }
+
+    _TMP112EnableShutdownMode();
+}
+
 bool SoilSensor::readMoistureRaw(uint16_t *moisture)
 {
-    if (!_ZSSC3123ReadRaw(moisture))
+    if (!_checkQuarantine())
     {
         return false;
     }
 
-    return true;
+    return _report(SOIL_SENSOR_CHANNEL_MOISTURE, _ZSSC3123ReadRaw(moisture));
 }
 
 bool SoilSensor::readMoisture(uint8_t *moisture)
@@ -73,11 +229,23 @@ bool SoilSensor::readMoistureInterval(uint16_t *moisture, uint16_t min, uint16_t
 {
     uint16_t raw;
 
-    if (!_ZSSC3123ReadRaw(&raw))
+    if (!_checkQuarantine())
     {
         return false;
     }
 
+    if (!_report(SOIL_SENSOR_CHANNEL_MOISTURE, _ZSSC3123ReadRaw(&raw)))
+    {
+        return false;
+    }
+
+    *moisture = _moistureInterval(raw, min, max);
+
+    return true;
+}
+
+uint16_t SoilSensor::_moistureInterval(uint16_t raw, uint16_t min, uint16_t max)
+{
     uint16_t *calibration = sensor.eeprom.calibration;
 
     int step = (max - min) / 10;
@@ -88,20 +256,14 @@ bool SoilSensor::readMoistureInterval(uint16_t *moisture, uint16_t min, uint16_t
         {
             if (i == 0)
             {
-                *moisture = min;
-
-                return true;
+                return min;
             }
 
-            *moisture = (((raw - calibration[i - 1]) * step) / (calibration[i] - calibration[i - 1])) + (step * (i - 1));
-
-            return true;
+            return (((raw - calibration[i - 1]) * step) / (calibration[i] - calibration[i - 1])) + (step * (i - 1));
         }
     }
 
-    *moisture = max;
-
-    return true;
+    return max;
 }
 
 void SoilSensor::wakeUp()
@@ -116,24 +278,267 @@ void SoilSensor::sleep()
 
 bool SoilSensor::readTemperatureCelsius(float *temperature)
 {
-    _TMP112StartOneShotConversion();
+    int16_t raw;
+
+    if (!readTemperatureRaw(&raw))
+    {
+        return false;
+    }
+
+    *temperature = raw * 0.0625;
+
+    return true;
+}
+
+bool SoilSensor::readTemperatureRaw(int16_t *temperature)
+{
+    if (!_checkQuarantine())
+    {
+        return false;
+    }
+
+    if (!_TMP112StartOneShotConversion() && _isBusFault())
+    {
+        return _report(SOIL_SENSOR_CHANNEL_TEMPERATURE, (soilSensorError) ds28e17.lastError());
+    }
 
     delay(1);
 
-    uint8_t buffer[2];
+    return _TMP112Read(temperature);
+}
 
-    if (!ds28e17.memoryRead(TMP112_ADDRESS, 0x00, buffer, 2))
+bool SoilSensor::startMeasurement()
+{
+    if (!_checkQuarantine())
+    {
+        state = SOIL_SENSOR_STATE_DONE;
+        finishedChannel = SOIL_SENSOR_CHANNEL_MOISTURE;
+
+        return false;
+    }
+
+    return _enterState(SOIL_SENSOR_STATE_MOISTURE_REQUEST);
+}
+
+bool SoilSensor::process()
+{
+    if ((state == SOIL_SENSOR_STATE_IDLE) || (state == SOIL_SENSOR_STATE_DONE))
+    {
+        return true;
+    }
+
+    if (state == SOIL_SENSOR_STATE_TEMPERATURE_WAIT)
+    {
+        if ((uint32_t) (micros() - stateTime) >= 1000)
+        {
+            _enterState(SOIL_SENSOR_STATE_TEMPERATURE_READ);
+        }
+
+        return state == SOIL_SENSOR_STATE_DONE;
+    }
+
+    if (ds28e17.isBusy())
+    {
+        if ((uint32_t) (micros() - stateTime) > (uint32_t) ONEWIRE_TIMEOUT * 1000)
+        {
+            ds28e17.abort();
+
+            _finishMeasurement(state <= SOIL_SENSOR_STATE_MOISTURE_READ ? SOIL_SENSOR_CHANNEL_MOISTURE : SOIL_SENSOR_CHANNEL_TEMPERATURE, SOIL_SENSOR_ERROR_TIMEOUT);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool success = ds28e17.end(stateBuffer);
+
+    switch (state)
+    {
+        case SOIL_SENSOR_STATE_MOISTURE_REQUEST:
+            // Status of the request is ignored as in the blocking read
+            _enterState(SOIL_SENSOR_STATE_MOISTURE_READ);
+            break;
+
+        case SOIL_SENSOR_STATE_MOISTURE_READ:
+        {
+            soilSensorError readError = success ? _ZSSC3123Decode(stateBuffer, &measuredMoisture) : (soilSensorError) ds28e17.lastError();
+
+            if (readError != SOIL_SENSOR_ERROR_NONE)
+            {
+                _finishMeasurement(SOIL_SENSOR_CHANNEL_MOISTURE, readError);
+                break;
+            }
+
+            _report(SOIL_SENSOR_CHANNEL_MOISTURE, SOIL_SENSOR_ERROR_NONE);
+
+            _enterState(SOIL_SENSOR_STATE_TEMPERATURE_TRIGGER);
+            break;
+        }
+
+        case SOIL_SENSOR_STATE_TEMPERATURE_TRIGGER:
+            state = SOIL_SENSOR_STATE_TEMPERATURE_WAIT;
+            stateTime = micros();
+            break;
+
+        case SOIL_SENSOR_STATE_TEMPERATURE_READ:
+            if (!success)
+            {
+                _finishMeasurement(SOIL_SENSOR_CHANNEL_TEMPERATURE, (soilSensorError) ds28e17.lastError());
+                break;
+            }
+
+            measuredTemperature = _TMP112Decode(stateBuffer);
+
+            _finishMeasurement(SOIL_SENSOR_CHANNEL_TEMPERATURE, SOIL_SENSOR_ERROR_NONE);
+            break;
+
+        default:
+            break;
+    }
+
+    return state == SOIL_SENSOR_STATE_DONE;
+}
+
+bool SoilSensor::getMeasurement(uint16_t *moisture, float *temperature)
+{
+    if ((state != SOIL_SENSOR_STATE_DONE) || (error != SOIL_SENSOR_ERROR_NONE))
+    {
+        return false;
+    }
+
+    *moisture = measuredMoisture;
+    *temperature = measuredTemperature * 0.0625;
+
+    return true;
+}
+
+bool SoilSensor::getMeasurement(soilSensorBatch *batch, uint16_t slot)
+{
+    if ((state != SOIL_SENSOR_STATE_DONE) || (slot >= batch->count))
+    {
+        return false;
+    }
+
+    soilSensorError moistureError = finishedChannel == SOIL_SENSOR_CHANNEL_MOISTURE ? error : SOIL_SENSOR_ERROR_NONE;
+
+    _storeBatch(batch, slot, measuredMoisture, moistureError, measuredTemperature, error);
+
+    return error == SOIL_SENSOR_ERROR_NONE;
+}
+
+bool SoilSensor::readBatch(soilSensorBatch *batch, uint16_t slot)
+{
+    if (slot >= batch->count)
     {
         return false;
     }
 
-    uint16_t temperatureRaw = buffer[0] << 8 | buffer[1];
+    uint16_t raw = 0;
+    int16_t temperature = 0;
+
+    bool success = readMoistureRaw(&raw);
+    soilSensorError moistureError = error;
+    soilSensorError temperatureError = error;
+
+    // TMP112 is read even if ZSSC3123 failed, unless the bridge does not answer at all
+    if (success || ((error != SOIL_SENSOR_ERROR_QUARANTINED) && !_isBusFault()))
+    {
+        success = readTemperatureRaw(&temperature) && success;
+        temperatureError = error;
+    }
+
+    _storeBatch(batch, slot, raw, moistureError, temperature, temperatureError);
+
+    return success;
+}
+
+void SoilSensor::_storeBatch(soilSensorBatch *batch, uint16_t slot, uint16_t raw, soilSensorError moistureError, int16_t temperature, soilSensorError temperatureError)
+{
+    if (moistureError != SOIL_SENSOR_ERROR_NONE)
+    {
+        raw = 0;
+    }
+
+    if (temperatureError != SOIL_SENSOR_ERROR_NONE)
+    {
+        temperature = 0;
+    }
+
+    // Fields without array are skipped, so the caller pays only for what it exports
+    if (batch->raw != NULL)
+    {
+        batch->raw[slot] = raw;
+    }
+
+    if (batch->moisture != NULL)
+    {
+        batch->moisture[slot] = moistureError == SOIL_SENSOR_ERROR_NONE ? _moistureInterval(raw, 0, 100) : 0;
+    }
 
-    *temperature = (temperatureRaw >> 4) * 0.0625;
+    if (batch->temperature != NULL)
+    {
+        batch->temperature[slot] = temperature;
+    }
+
+    if (batch->status != NULL)
+    {
+        batch->status[slot] = moistureError != SOIL_SENSOR_ERROR_NONE ? moistureError : temperatureError;
+    }
+
+    if (batch->timestamp != NULL)
+    {
+        batch->timestamp[slot] = millis();
+    }
+}
+
+bool SoilSensor::_enterState(soilSensorState next)
+{
+    uint8_t request[1] = { ZSSC3123_MEASURE };
+    uint8_t trigger[2] = TMP112_MEASURE;
+    bool started = true;
+
+    state = next;
+    stateTime = micros();
+
+    switch (next)
+    {
+        case SOIL_SENSOR_STATE_MOISTURE_REQUEST:
+            started = ds28e17.beginWrite(ZSSC3123_ADDRESS, request, 1);
+            break;
+
+        case SOIL_SENSOR_STATE_MOISTURE_READ:
+            started = ds28e17.beginRead(ZSSC3123_ADDRESS, 2);
+            break;
+
+        case SOIL_SENSOR_STATE_TEMPERATURE_TRIGGER:
+            started = ds28e17.beginMemoryWrite(TMP112_ADDRESS, TMP112_REGISTER, trigger, 2);
+            break;
+
+        case SOIL_SENSOR_STATE_TEMPERATURE_READ:
+            started = ds28e17.beginMemoryRead(TMP112_ADDRESS, 0x00, 2);
+            break;
+
+        default:
+            break;
+    }
+
+    if (!started)
+    {
+        return _finishMeasurement(next <= SOIL_SENSOR_STATE_MOISTURE_READ ? SOIL_SENSOR_CHANNEL_MOISTURE : SOIL_SENSOR_CHANNEL_TEMPERATURE, (soilSensorError) ds28e17.lastError());
+    }
 
     return true;
 }
 
+bool SoilSensor::_finishMeasurement(soilSensorChannel channel, soilSensorError measurementError)
+{
+    state = SOIL_SENSOR_STATE_DONE;
+    finishedChannel = channel;
+
+    return _report(channel, measurementError);
+}
+
 bool SoilSensor::readTemperatureFahrenheit(float *temperature)
 {
     float a;
@@ -162,6 +567,101 @@ bool SoilSensor::readTemperatureKelvin(float *temperature)
     return true;
 }
 
+soilSensorError SoilSensor::lastError()
+{
+    return error;
+}
+
+uint8_t SoilSensor::health()
+{
+    uint8_t score = SOIL_SENSOR_HEALTH_MAX;
+
+    for (int i = 0; i < SOIL_SENSOR_CHANNEL_COUNT; i++)
+    {
+        if (healthScore[i] < score)
+        {
+            score = healthScore[i];
+        }
+    }
+
+    return score;
+}
+
+bool SoilSensor::isQuarantined()
+{
+    if (quarantineTime == 0)
+    {
+        return false;
+    }
+
+    return (uint32_t) (millis() - quarantineStart) < quarantineTime;
+}
+
+bool SoilSensor::_checkQuarantine()
+{
+    if (isQuarantined())
+    {
+        error = SOIL_SENSOR_ERROR_QUARANTINED;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool SoilSensor::_report(soilSensorChannel channel, soilSensorError readError)
+{
+    error = readError;
+
+    // Channels are counted apart, so a working TMP112 does not hide a failing ZSSC3123
+    if (readError == SOIL_SENSOR_ERROR_NONE)
+    {
+        healthScore[channel] = healthScore[channel] + SOIL_SENSOR_HEALTH_GAIN > SOIL_SENSOR_HEALTH_MAX ? SOIL_SENSOR_HEALTH_MAX : healthScore[channel] + SOIL_SENSOR_HEALTH_GAIN;
+        failures[channel] = 0;
+
+        for (int i = 0; i < SOIL_SENSOR_CHANNEL_COUNT; i++)
+        {
+            if (failures[i] >= SOIL_SENSOR_QUARANTINE_FAILURES)
+            {
+                return true;
+            }
+        }
+
+        quarantineTime = 0;
+
+        return true;
+    }
+
+    healthScore[channel] = healthScore[channel] > SOIL_SENSOR_HEALTH_LOSS ? healthScore[channel] - SOIL_SENSOR_HEALTH_LOSS : 0;
+
+    if (failures[channel] < 0xff)
+    {
+        failures[channel]++;
+    }
+
+    if (failures[channel] >= SOIL_SENSOR_QUARANTINE_FAILURES)
+    {
+        // Every failed probe after an expired quarantine doubles the back-off
+        quarantineTime = quarantineTime == 0 ? SOIL_SENSOR_QUARANTINE_BASE : quarantineTime * 2;
+
+        if (quarantineTime > SOIL_SENSOR_QUARANTINE_MAX)
+        {
+            quarantineTime = SOIL_SENSOR_QUARANTINE_MAX;
+        }
+
+        quarantineStart = millis();
+    }
+
+    return false;
+}
+
+bool SoilSensor::_isBusFault()
+{
+    ds28e17Error busError = ds28e17.lastError();
+
+    return busError == DS28E17_ERROR_PRESENCE || busError == DS28E17_ERROR_TIMEOUT;
+}
+
 bool SoilSensor::_EEPROMRead(uint8_t address, void *buffer, size_t length)
 {
     uint8_t a[8];
@@ -233,9 +733,12 @@ bool SoilSensor::_EEPROMLoad()
 
     soilSensorEepromHeader header;
 
+    // Stop at a failed read, so its error is the last one of DS28E17
     if (!_EEPROMRead(0, &header, sizeof(header)))
     {
-        error = true;
+        _EEPROMFill();
+
+        return false;
     }
 
     /*
@@ -267,10 +770,12 @@ bool SoilSensor::_EEPROMLoad()
 
     if (!_EEPROMRead(sizeof(header), &sensor.eeprom, sizeof(soilSensorEeprom)))
     {
-        error = true;
+        _EEPROMFill();
+
+        return false;
     }
 
-    if (header.crc != oneWire->crc16(&sensor.eeprom.product, sizeof(soilSensorEeprom), 0))
+    if (header.crc != OneWire::crc16(&sensor.eeprom.product, sizeof(soilSensorEeprom), 0))
     {
         error = true;
     }
@@ -296,32 +801,69 @@ bool SoilSensor::_EEPROMLoad()
     Serial.println();
     */
 
-    return error;
+    return !error;
 }
 
-bool SoilSensor::_ZSSC3123ReadRaw(uint16_t *cap)
+soilSensorError SoilSensor::_ZSSC3123ReadRaw(uint16_t *cap)
 {
     uint8_t data[1] = { ZSSC3123_MEASURE };
 
-    ds28e17.write(ZSSC3123_ADDRESS, data, 1);
+    if (!ds28e17.write(ZSSC3123_ADDRESS, data, 1) && _isBusFault())
+    {
+        return (soilSensorError) ds28e17.lastError();
+    }
 
     uint8_t buffer[2];
 
     if (ds28e17.read(ZSSC3123_ADDRESS, buffer, 2) == false)
     {
-        return false;
+        return (soilSensorError) ds28e17.lastError();
     }
 
+    return _ZSSC3123Decode(buffer, cap);
+}
+
+soilSensorError SoilSensor::_ZSSC3123Decode(uint8_t *buffer, uint16_t *cap)
+{
     uint16_t value = buffer[0] << 8 | buffer[1];
 
-    if ((value & 0xc000) == 0)
+    switch (value & 0xc000)
     {
-        *cap = value & 0xbffff;
+        case 0x0000:
+            *cap = value & 0xbffff;
 
-        return true;
+            return SOIL_SENSOR_ERROR_NONE;
+
+        case 0x4000:
+            return SOIL_SENSOR_ERROR_STALE;
+
+        default:
+            return SOIL_SENSOR_ERROR_DIAGNOSTIC;
     }
+}
 
-    return false;
+int16_t SoilSensor::_TMP112Decode(uint8_t *buffer)
+{
+    int16_t temperatureRaw = buffer[0] << 8 | buffer[1];
+
+    // Arithmetic shift keeps the sign of temperatures below zero
+    return temperatureRaw >> 4;
+}
+
+bool SoilSensor::_TMP112Read(int16_t *temperature)
+{
+    uint8_t buffer[2];
+
+    if (!ds28e17.memoryRead(TMP112_ADDRESS, 0x00, buffer, 2))
+    {
+        return _report(SOIL_SENSOR_CHANNEL_TEMPERATURE, (soilSensorError) ds28e17.lastError());
+    }
+
+    _report(SOIL_SENSOR_CHANNEL_TEMPERATURE, SOIL_SENSOR_ERROR_NONE);
+
+    *temperature = _TMP112Decode(buffer);
+
+    return true;
 }
 
 bool SoilSensor::_TMP112EnableShutdownMode()
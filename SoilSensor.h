@@ -43,6 +43,68 @@ MIT License
 #define BC_SOIL_SENSOR_REV_WITH_EEPROM 0x0104
 
 #define SEARCH_TIMEOUT 50
+#define DS28E17_FAMILY 0x19
+
+#define SOIL_SENSOR_HEALTH_MAX 100
+#define SOIL_SENSOR_HEALTH_GAIN 10
+#define SOIL_SENSOR_HEALTH_LOSS 25
+#define SOIL_SENSOR_QUARANTINE_FAILURES 3
+#define SOIL_SENSOR_QUARANTINE_BASE 1000
+#define SOIL_SENSOR_QUARANTINE_MAX 300000
+
+/**
+ * @brief Soil sensor error, bus errors share values with ds28e17Error.
+ */
+typedef enum
+{
+    SOIL_SENSOR_ERROR_NONE = DS28E17_ERROR_NONE,                 //! @brief Read was successful
+    SOIL_SENSOR_ERROR_PRESENCE = DS28E17_ERROR_PRESENCE,         //! @brief No presence pulse after 1-Wire reset
+    SOIL_SENSOR_ERROR_TIMEOUT = DS28E17_ERROR_TIMEOUT,           //! @brief DS28E17 busy timeout
+    SOIL_SENSOR_ERROR_CRC = DS28E17_ERROR_CRC,                   //! @brief DS28E17 reported CRC error
+    SOIL_SENSOR_ERROR_ADDRESS_NACK = DS28E17_ERROR_ADDRESS_NACK, //! @brief I2C address not acknowledged
+    SOIL_SENSOR_ERROR_START = DS28E17_ERROR_START,               //! @brief I2C start condition not generated
+    SOIL_SENSOR_ERROR_WRITE_NACK = DS28E17_ERROR_WRITE_NACK,     //! @brief I2C data not acknowledged
+    SOIL_SENSOR_ERROR_STALE,                                     //! @brief ZSSC3123 returned already read data
+    SOIL_SENSOR_ERROR_DIAGNOSTIC,                                //! @brief ZSSC3123 returned command mode or diagnostic status
+    SOIL_SENSOR_ERROR_QUARANTINED                                //! @brief Sensor is quarantined after repeated failures
+} soilSensorError;
+
+/**
+ * @brief Caller-owned result arrays of a batch read indexed by sensor slot, NULL arrays are skipped.
+ */
+typedef struct
+{
+    uint16_t count;         //! @brief Number of slots in every array
+    uint16_t *raw;          //! @brief Raw moisture
+    uint8_t *moisture;      //! @brief Moisture in percent
+    int16_t *temperature;   //! @brief Temperature in fixed-point 1/16 Celsius
+    uint8_t *status;        //! @brief soilSensorError of the read
+    uint32_t *timestamp;    //! @brief Time of the read in milliseconds
+} soilSensorBatch;
+
+/**
+ * @brief Measurement channel with its own health score and failure count.
+ */
+typedef enum
+{
+    SOIL_SENSOR_CHANNEL_MOISTURE = 0,   //! @brief ZSSC3123 moisture
+    SOIL_SENSOR_CHANNEL_TEMPERATURE,    //! @brief TMP112 temperature
+    SOIL_SENSOR_CHANNEL_COUNT           //! @brief Number of channels
+} soilSensorChannel;
+
+/**
+ * @brief Step of the non-blocking measurement.
+ */
+typedef enum
+{
+    SOIL_SENSOR_STATE_IDLE = 0,            //! @brief No measurement started
+    SOIL_SENSOR_STATE_MOISTURE_REQUEST,    //! @brief ZSSC3123 measurement request
+    SOIL_SENSOR_STATE_MOISTURE_READ,       //! @brief ZSSC3123 data read
+    SOIL_SENSOR_STATE_TEMPERATURE_TRIGGER, //! @brief TMP112 one-shot conversion trigger
+    SOIL_SENSOR_STATE_TEMPERATURE_WAIT,    //! @brief TMP112 conversion wait
+    SOIL_SENSOR_STATE_TEMPERATURE_READ,    //! @brief TMP112 data read
+    SOIL_SENSOR_STATE_DONE                 //! @brief Measurement finished
+} soilSensorState;
 
 /**
  * @brief Soil sensor header stored in EEPROM.
@@ -78,18 +140,60 @@ typedef struct
 
 class SoilSensor
 {
+  friend class SoilSensorGroup;
+
   public:
     /**
       * @brief       Constructor of SoilSensor class.
       */
     SoilSensor(OneWire *oneWire);
     
+    /**
+      * @brief       Constructor of SoilSensor class using custom 1-Wire transport.
+      */
+    SoilSensor(OneWireBus *oneWireBus);
+    
     /**
       * @brief       Search and init sensor.
       * @return      True if searched, otherwise false.
       */
     bool begin();
     
+    /**
+      * @brief       Init sensor with known address, fall back to a family search if it does not answer.
+      *              Another sensor is adopted only if it is the only DS28E17 on the bus.
+      * @param[in]   rom   address stored from getAddress()
+      * @return      True if a sensor was found, otherwise false.
+      */
+    bool begin(const uint8_t rom[8]);
+    
+    /**
+      * @brief       Init sensor with known address and calibration, EEPROM is read only if another sensor is found.
+      * @param[in]   rom           address stored from getAddress()
+      * @param[in]   calibration   calibration stored from getCalibration()
+      * @return      True if a sensor was found, otherwise false.
+      */
+    bool begin(const uint8_t rom[8], const soilSensorEeprom *calibration);
+    
+    /**
+      * @brief       Get calibration of the sensor, e.g. to be stored for begin(rom, calibration).
+      * @param[out]  calibration   calibration of the sensor
+      */
+    void getCalibration(soilSensorEeprom *calibration);
+    
+    /**
+      * @brief       Get address of the sensor, e.g. to be stored for begin(rom).
+      * @param[out]  rom   address of the sensor
+      */
+    void getAddress(uint8_t rom[8]);
+    
+    /**
+      * @brief       Check if the last begin(rom) found another sensor than the stored one,
+      *              or the last begin() another sensor than the one with loaded calibration.
+      * @return      True if the sensor was swapped, otherwise false.
+      */
+    bool isSwapped();
+    
     /**
      * @brief       Wake up asleep soil sensor.
      */
@@ -121,6 +225,13 @@ class SoilSensor
      */
     bool readTemperatureCelsius(float *temperature); 
     
+    /**
+     * @brief       Read temperature in fixed-point 1/16 Celsius from soil sensor.
+     * @param[out]  temperature   temperature to be read
+     * @return      True if the read was successful, otherwise false.
+     */
+    bool readTemperatureRaw(int16_t *temperature); 
+    
     /**
      * @brief       Read temperature in Kelvin from soil sensor.
      * @param[out]  temperature   temperature to be read
@@ -135,12 +246,61 @@ class SoilSensor
      */
     bool readTemperatureFahrenheit(float *temperature);
     
-  private:
     /**
-     * @brief       Pointer to OneWire object.
+     * @brief       Start non-blocking measurement of raw moisture and temperature, advance it by process().
+     * @return      True if the measurement was started, otherwise false.
+     */
+    bool startMeasurement();
+    
+    /**
+     * @brief       Advance the measurement without waiting for DS28E17.
+     * @return      True if the measurement finished, false if it is still in progress.
+     */
+    bool process();
+    
+    /**
+     * @brief       Get result of the finished measurement.
+     * @param[out]  moisture      raw moisture
+     * @param[out]  temperature   temperature in Celsius
+     * @return      True if the measurement was successful, otherwise false.
      */
-    OneWire *oneWire;
+    bool getMeasurement(uint16_t *moisture, float *temperature);
     
+    /**
+     * @brief       Store result of the finished measurement into batch arrays.
+     * @param[out]  batch   batch arrays
+     * @param       slot    index of the sensor in the arrays
+     * @return      True if the measurement was successful, false if it failed or slot is out of the arrays.
+     */
+    bool getMeasurement(soilSensorBatch *batch, uint16_t slot);
+    
+    /**
+     * @brief       Read raw moisture and temperature directly into batch arrays.
+     * @param[out]  batch   batch arrays
+     * @param       slot    index of the sensor in the arrays
+     * @return      True if the read was successful, false if it failed or slot is out of the arrays.
+     */
+    bool readBatch(soilSensorBatch *batch, uint16_t slot);
+    
+    /**
+     * @brief       Get error of the last read.
+     * @return      Error of the last read, SOIL_SENSOR_ERROR_NONE if it was successful.
+     */
+    soilSensorError lastError();
+    
+    /**
+     * @brief       Get health score of the sensor, the lower score of its channels.
+     * @return      Health score from 0 (failing) to SOIL_SENSOR_HEALTH_MAX (healthy).
+     */
+    uint8_t health();
+    
+    /**
+     * @brief       Check if the sensor is quarantined after repeated failures.
+     * @return      True if reads are skipped until the back-off expires, otherwise false.
+     */
+    bool isQuarantined();
+    
+  private:
     /**
      * @brief       DS28E17 (1-wire <-> I2C converter) object.
      */
@@ -151,6 +311,135 @@ class SoilSensor
      */
     soilSensorT sensor;
     
+    /**
+     * @brief       Address of the sensor whose calibration is loaded, zero if none or if the load failed on the bus.
+     */
+    uint8_t calibratedAddress[8];
+    
+    /**
+     * @brief       True if the last begin found a different sensor.
+     */
+    bool swapped;
+    
+    /**
+     * @brief       Search DS28E17 family for the stored sensor or the only sensor on the bus.
+     * @param[in]   rom   stored address
+     * @return      True if the sensor address was found, otherwise false.
+     */
+    bool _search(const uint8_t rom[8]);
+    
+    /**
+     * @brief       Reset health if the sensor changed, load calibration unless it is loaded for this sensor and disable TMP112.
+     * @param[in]   previous  address attached before this begin
+     */
+    void _attach(const uint8_t previous[8]);
+    
+    /**
+     * @brief       Error of the last read.
+     */
+    soilSensorError error;
+    
+    /**
+     * @brief       Health score of every channel.
+     */
+    uint8_t healthScore[SOIL_SENSOR_CHANNEL_COUNT];
+    
+    /**
+     * @brief       Number of consecutive failed reads of every channel.
+     */
+    uint8_t failures[SOIL_SENSOR_CHANNEL_COUNT];
+    
+    /**
+     * @brief       Start of the quarantine in milliseconds.
+     */
+    uint32_t quarantineStart;
+    
+    /**
+     * @brief       Length of the quarantine in milliseconds, 0 if not quarantined.
+     */
+    uint32_t quarantineTime;
+    
+    /**
+     * @brief       Step of the non-blocking measurement.
+     */
+    soilSensorState state;
+    
+    /**
+     * @brief       Start of the current step in microseconds.
+     */
+    uint32_t stateTime;
+    
+    /**
+     * @brief       Data read by the current step.
+     */
+    uint8_t stateBuffer[2];
+    
+    /**
+     * @brief       Result of the non-blocking measurement.
+     */
+    uint16_t measuredMoisture;
+    int16_t measuredTemperature;
+    
+    /**
+     * @brief       Channel of the step which finished the measurement, the channels after a failed one are not measured.
+     */
+    soilSensorChannel finishedChannel;
+    
+    /**
+     * @brief       Store one slot of batch arrays, fields of a failed channel are stored as 0.
+     * @param[out]  batch               batch arrays
+     * @param       slot                index of the sensor in the arrays
+     * @param       raw                 raw moisture
+     * @param       moistureError       error of the moisture read
+     * @param       temperature         temperature in fixed-point 1/16 Celsius
+     * @param       temperatureError    error of the temperature read
+     */
+    void _storeBatch(soilSensorBatch *batch, uint16_t slot, uint16_t raw, soilSensorError moistureError, int16_t temperature, soilSensorError temperatureError);
+    
+    /**
+     * @brief       Transform raw moisture to defined interval by calibration.
+     * @param       raw     raw moisture
+     * @param       min     minimal value of defined interval
+     * @param       max     maximal value of defined interval
+     * @return      Transformed moisture.
+     */
+    uint16_t _moistureInterval(uint16_t raw, uint16_t min, uint16_t max);
+    
+    /**
+     * @brief       Enter step of the measurement and start its transaction.
+     * @param       next    step to be entered
+     * @return      True if the transaction was started, otherwise false and the measurement is finished.
+     */
+    bool _enterState(soilSensorState next);
+    
+    /**
+     * @brief       Finish the measurement.
+     * @param       channel           channel of the last step
+     * @param       measurementError  error of the measurement
+     * @return      True if the measurement was successful, otherwise false.
+     */
+    bool _finishMeasurement(soilSensorChannel channel, soilSensorError measurementError);
+    
+    /**
+     * @brief       Check quarantine before a read.
+     * @return      True if the read may proceed, false if the sensor is quarantined.
+     */
+    bool _checkQuarantine();
+    
+    /**
+     * @brief       Record result of a read, update health score of the channel and quarantine.
+     * @param       channel     channel of the read
+     * @param       readError   error of the read
+     * @return      True if the read was successful, otherwise false.
+     */
+    bool _report(soilSensorChannel channel, soilSensorError readError);
+    
+    /**
+     * @brief       Check if the last DS28E17 transaction found no responding device.
+     * @return      True if the device is missing or stuck busy, otherwise false.
+     */
+    bool _isBusFault();
+    
     /**
      * @brief       Read values from EEPROM memmory on sensor.
      * @param       address   address from which is readed
@@ -174,9 +463,24 @@ class SoilSensor
     /**
      * @brief       Read raw capacity from ZSSC3123 circuit.
      * @param[out]  cap    capacity to be read
-     * @return      True if the read was successful, otherwise false.
+     * @return      Error of the read, SOIL_SENSOR_ERROR_NONE if it was successful.
      */ 
-    bool _ZSSC3123ReadRaw(uint16_t *cap);
+    soilSensorError _ZSSC3123ReadRaw(uint16_t *cap);
+    
+    /**
+     * @brief       Decode data read from ZSSC3123 circuit.
+     * @param[in]   buffer  two bytes read from ZSSC3123
+     * @param[out]  cap     capacity
+     * @return      Error of the status bits, SOIL_SENSOR_ERROR_NONE if the data are valid.
+     */
+    soilSensorError _ZSSC3123Decode(uint8_t *buffer, uint16_t *cap);
+    
+    /**
+     * @brief       Decode temperature register of TMP112.
+     * @param[in]   buffer  two bytes read from TMP112
+     * @return      Temperature in fixed-point 1/16 Celsius.
+     */
+    int16_t _TMP112Decode(uint8_t *buffer);
     
     /**
      * @brief       Enable sutdown (power save) mode of TMP112.
@@ -190,6 +494,13 @@ class SoilSensor
      */ 
     bool _TMP112StartOneShotConversion();
     
+    /**
+     * @brief       Read converted temperature from TMP112 without starting a conversion.
+     * @param[out]  temperature   temperature in fixed-point 1/16 Celsius
+     * @return      True if the read was successful, otherwise false.
+     */ 
+    bool _TMP112Read(int16_t *temperature);
+    
     /**
      * @brief       Read moisture from soil sensor tranformed to defined interval.
      * @param[out]  moisture  moisture to be read
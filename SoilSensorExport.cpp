@@ -0,0 +1,114 @@
+#include "SoilSensorExport.h"
+#include "Arduino.h"
+
+void SoilSensorExport::print(const soilSensorBatch *batch, uint16_t count, Print &out)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        out.print(i);
+
+        if (batch->timestamp != NULL)
+        {
+            out.print(" ");
+            out.print(batch->timestamp[i]);
+        }
+
+        if (batch->status != NULL)
+        {
+            out.print(" ");
+            out.print(batch->status[i]);
+        }
+
+        if (batch->temperature != NULL)
+        {
+            out.print(" ");
+            out.print(batch->temperature[i] * 0.0625);
+        }
+
+        if (batch->moisture != NULL)
+        {
+            out.print(" ");
+            out.print(batch->moisture[i]);
+        }
+
+        if (batch->raw != NULL)
+        {
+            out.print(" ");
+            out.print(batch->raw[i]);
+        }
+
+        out.println();
+    }
+}
+
+size_t SoilSensorExport::write(const soilSensorBatch *batch, uint16_t count, Print &out)
+{
+    uint8_t header[3];
+
+    header[0] = count;
+    header[1] = count >> 8;
+    header[2] = (batch->raw != NULL ? SOIL_SENSOR_EXPORT_RAW : 0) |
+                (batch->moisture != NULL ? SOIL_SENSOR_EXPORT_MOISTURE : 0) |
+                (batch->temperature != NULL ? SOIL_SENSOR_EXPORT_TEMPERATURE : 0) |
+                (batch->status != NULL ? SOIL_SENSOR_EXPORT_STATUS : 0) |
+                (batch->timestamp != NULL ? SOIL_SENSOR_EXPORT_TIMESTAMP : 0);
+
+    size_t written = out.write(header, sizeof(header));
+
+    if (batch->raw != NULL)
+    {
+        written += _writeArray(batch->raw, sizeof(batch->raw[0]), count, out);
+    }
+
+    if (batch->moisture != NULL)
+    {
+        written += out.write(batch->moisture, count);
+    }
+
+    if (batch->temperature != NULL)
+    {
+        written += _writeArray(batch->temperature, sizeof(batch->temperature[0]), count, out);
+    }
+
+    if (batch->status != NULL)
+    {
+        written += out.write(batch->status, count);
+    }
+
+    if (batch->timestamp != NULL)
+    {
+        written += _writeArray(batch->timestamp, sizeof(batch->timestamp[0]), count, out);
+    }
+
+    return written;
+}
+
+size_t SoilSensorExport::_writeArray(const void *array, uint8_t size, uint16_t count, Print &out)
+{
+#if SOIL_SENSOR_EXPORT_IN_PLACE
+    // Memory already holds the exported form
+    return out.write((const uint8_t *) array, count * size);
+#else
+    uint8_t buffer[32];
+    size_t length = 0;
+    size_t written = 0;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint32_t value = size == 4 ? ((const uint32_t *) array)[i] : ((const uint16_t *) array)[i];
+
+        for (uint8_t j = 0; j < size; j++)
+        {
+            buffer[length++] = value >> (8 * j);
+        }
+
+        if (length + size > sizeof(buffer))
+        {
+            written += out.write(buffer, length);
+            length = 0;
+        }
+    }
+
+    return written + out.write(buffer, length);
+#endif
+}
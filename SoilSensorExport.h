@@ -0,0 +1,68 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+Export of batch arrays, the arrays are read in place without copying. Binary
+export is little endian, on little endian CPUs the arrays are written as they
+are in memory, other CPUs encode them through a small buffer.
+
+*/
+#ifndef SoilSensorExport_h
+#define SoilSensorExport_h
+
+#include "Arduino.h"
+#include "SoilSensor.h"
+
+#define SOIL_SENSOR_EXPORT_RAW 0x01
+#define SOIL_SENSOR_EXPORT_MOISTURE 0x02
+#define SOIL_SENSOR_EXPORT_TEMPERATURE 0x04
+#define SOIL_SENSOR_EXPORT_STATUS 0x08
+#define SOIL_SENSOR_EXPORT_TIMESTAMP 0x10
+
+#ifndef SOIL_SENSOR_EXPORT_IN_PLACE
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SOIL_SENSOR_EXPORT_IN_PLACE 1
+#else
+#define SOIL_SENSOR_EXPORT_IN_PLACE 0
+#endif
+#endif
+
+class SoilSensorExport
+{
+  public:
+    /**
+     * @brief       Print batch as text, one line per slot with the fields present in the batch.
+     * @param[in]   batch   batch arrays
+     * @param       count   number of slots to be printed
+     * @param       out     output such as Serial
+     */
+    static void print(const soilSensorBatch *batch, uint16_t count, Print &out);
+    
+    /**
+     * @brief       Write batch in binary form, every present array is written at once in little endian.
+     * @param[in]   batch   batch arrays
+     * @param       count   number of slots to be written
+     * @param       out     output such as Serial
+     * @return      Number of written bytes.
+     */
+    static size_t write(const soilSensorBatch *batch, uint16_t count, Print &out);
+    
+  private:
+    /**
+     * @brief       Write array of unsigned values in little endian.
+     * @param[in]   array   array to be written
+     * @param       size    size of one value in bytes
+     * @param       count   number of values
+     * @param       out     output such as Serial
+     * @return      Number of written bytes.
+     */
+    static size_t _writeArray(const void *array, uint8_t size, uint16_t count, Print &out);
+};
+
+#endif
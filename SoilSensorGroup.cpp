@@ -0,0 +1,150 @@
+#include "SoilSensorGroup.h"
+#include "Arduino.h"
+
+SoilSensorGroup::SoilSensorGroup()
+{
+    sensorsCount = 0;
+}
+
+bool SoilSensorGroup::add(SoilSensor *soilSensor)
+{
+    if (sensorsCount == SOIL_SENSOR_GROUP_MAX)
+    {
+        return false;
+    }
+
+    sensors[sensorsCount++] = soilSensor;
+
+    return true;
+}
+
+uint8_t SoilSensorGroup::count()
+{
+    return sensorsCount;
+}
+
+SoilSensor *SoilSensorGroup::getSensor(uint8_t slot)
+{
+    return sensors[slot];
+}
+
+void SoilSensorGroup::wakeUp()
+{
+    if (sensorsCount == 0)
+    {
+        return;
+    }
+
+    // Reset pulse is seen by every device on the bus
+    sensors[0]->wakeUp();
+}
+
+void SoilSensorGroup::sleep()
+{
+    if (sensorsCount == 1)
+    {
+        sensors[0]->sleep();
+    }
+    else if (sensorsCount > 1)
+    {
+        sensors[0]->ds28e17.enableSleepModeAll();
+    }
+}
+
+bool SoilSensorGroup::_isBroadcastable(SoilSensor *soilSensor)
+{
+    return !soilSensor->isQuarantined() && (soilSensor->lastError() == SOIL_SENSOR_ERROR_NONE);
+}
+
+bool SoilSensorGroup::readTemperatureRaw(int16_t *temperatures)
+{
+    uint8_t broadcastable = 0;
+
+    for (uint8_t i = 0; i < sensorsCount; i++)
+    {
+        if (_isBroadcastable(sensors[i]))
+        {
+            broadcastable++;
+        }
+    }
+
+    bool triggered = false;
+
+    if (broadcastable > 1)
+    {
+        uint8_t data[2] = TMP112_MEASURE;
+
+        triggered = sensors[0]->ds28e17.memoryWriteAll(TMP112_ADDRESS, TMP112_REGISTER, data, 2);
+
+        delay(1);
+    }
+
+    bool success = true;
+
+    for (uint8_t i = 0; i < sensorsCount; i++)
+    {
+        if (triggered && _isBroadcastable(sensors[i]))
+        {
+            if (sensors[i]->_TMP112Read(&temperatures[i]))
+            {
+                continue;
+            }
+
+            if (sensors[i]->_isBusFault())
+            {
+                success = false;
+                continue;
+            }
+        }
+
+        // Individual trigger for sensors which failed or missed the broadcast
+        if (!sensors[i]->readTemperatureRaw(&temperatures[i]))
+        {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+bool SoilSensorGroup::readBatch(soilSensorBatch *batch)
+{
+    if (batch->count < sensorsCount)
+    {
+        return false;
+    }
+
+    int16_t temperatures[SOIL_SENSOR_GROUP_MAX] = { 0 };
+
+    bool success = readTemperatureRaw(temperatures);
+
+    for (uint8_t i = 0; i < sensorsCount; i++)
+    {
+        // Errors are kept per field, so a failed temperature does not void the moisture
+        soilSensorError temperatureError = sensors[i]->lastError();
+        uint16_t raw = 0;
+
+        if (!sensors[i]->readMoistureRaw(&raw))
+        {
+            success = false;
+        }
+
+        sensors[i]->_storeBatch(batch, i, raw, sensors[i]->lastError(), temperatures[i], temperatureError);
+    }
+
+    return success;
+}
+
+bool SoilSensorGroup::readTemperatureCelsius(float *temperatures)
+{
+    int16_t raw[SOIL_SENSOR_GROUP_MAX];
+
+    bool success = readTemperatureRaw(raw);
+
+    for (uint8_t i = 0; i < sensorsCount; i++)
+    {
+        temperatures[i] = sensors[i]->lastError() == SOIL_SENSOR_ERROR_NONE ? raw[i] * 0.0625 : NAN;
+    }
+
+    return success;
+}
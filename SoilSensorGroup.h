@@ -0,0 +1,97 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+Group of sensors sharing one 1-Wire bus. Sleep, wake up and TMP112 conversion
+trigger are sent once to the whole bus instead of to every sensor.
+
+*/
+#ifndef SoilSensorGroup_h
+#define SoilSensorGroup_h
+
+#include "Arduino.h"
+#include "SoilSensor.h"
+
+#define SOIL_SENSOR_GROUP_MAX 16
+
+class SoilSensorGroup
+{
+  public:
+    /**
+      * @brief       Constructor of SoilSensorGroup class.
+      */
+    SoilSensorGroup();
+    
+    /**
+     * @brief       Add sensor, all sensors have to be on the same 1-Wire bus.
+     * @param       soilSensor    sensor initialized by begin(rom)
+     * @return      True if added, false if SOIL_SENSOR_GROUP_MAX sensors were already added.
+     */
+    bool add(SoilSensor *soilSensor);
+    
+    /**
+     * @brief       Get number of added sensors.
+     * @return      Number of sensors.
+     */
+    uint8_t count();
+    
+    /**
+     * @brief       Get added sensor.
+     * @param       slot    index of the sensor in order of adding
+     * @return      Pointer to the sensor.
+     */
+    SoilSensor *getSensor(uint8_t slot);
+    
+    /**
+     * @brief       Wake up all sensors on the bus by a single reset pulse.
+     */
+    void wakeUp();
+    
+    /**
+     * @brief       Put all sensors on the bus into sleep mode by Skip ROM.
+     */
+    void sleep();
+    
+    /**
+     * @brief       Read temperature of all sensors, the conversion is triggered by Skip ROM.
+     * @param[out]  temperatures  temperature in fixed-point 1/16 Celsius for every slot
+     * @return      True if all reads were successful, otherwise false.
+     */
+    bool readTemperatureRaw(int16_t *temperatures);
+    
+    /**
+     * @brief       Read temperature in Celsius of all sensors, the conversion is triggered by Skip ROM.
+     * @param[out]  temperatures  temperature for every slot, NAN if the read failed
+     * @return      True if all reads were successful, otherwise false.
+     */
+    bool readTemperatureCelsius(float *temperatures);
+    
+    /**
+     * @brief       Read moisture and temperature of all sensors into batch arrays, slot is the order of adding.
+     * @param[out]  batch   batch arrays with at least count() slots
+     * @return      True if all reads were successful, otherwise false.
+     */
+    bool readBatch(soilSensorBatch *batch);
+    
+  private:
+    /**
+     * @brief       Sensors on the bus.
+     */
+    SoilSensor *sensors[SOIL_SENSOR_GROUP_MAX];
+    uint8_t sensorsCount;
+    
+    /**
+     * @brief       Check if the sensor can rely on broadcast commands.
+     * @param       soilSensor    sensor to be checked
+     * @return      True if the sensor answered last time, false if it has to be treated individually.
+     */
+    bool _isBroadcastable(SoilSensor *soilSensor);
+};
+
+#endif
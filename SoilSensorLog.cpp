@@ -0,0 +1,268 @@
+#include "SoilSensorLog.h"
+#include "Arduino.h"
+
+SoilSensorLog::SoilSensorLog(uint8_t *buffer, size_t size)
+{
+    blocks = buffer;
+    blocksCount = size / SOIL_SENSOR_LOG_BLOCK_SIZE;
+    blockPager = NULL;
+
+    clear();
+}
+
+void SoilSensorLog::clear()
+{
+    blocksFirst = 0;
+    blocksUsed = 0;
+    sealed = false;
+}
+
+void SoilSensorLog::setPager(void (*pager)(const uint8_t *block, size_t size))
+{
+    blockPager = pager;
+}
+
+bool SoilSensorLog::flush()
+{
+    if ((blockPager == NULL) || (blocksUsed == 0) || sealed)
+    {
+        return false;
+    }
+
+    blockPager(_block(blocksUsed - 1), SOIL_SENSOR_LOG_BLOCK_SIZE);
+
+    sealed = true;
+
+    return true;
+}
+
+uint16_t SoilSensorLog::count()
+{
+    uint16_t samples = 0;
+
+    soilSensorLogHeader header;
+
+    for (uint16_t i = 0; i < blocksUsed; i++)
+    {
+        _readHeader(_block(i), &header);
+        samples += header.count;
+    }
+
+    return samples;
+}
+
+size_t SoilSensorLog::length()
+{
+    size_t used = 0;
+
+    soilSensorLogHeader header;
+
+    for (uint16_t i = 0; i < blocksUsed; i++)
+    {
+        _readHeader(_block(i), &header);
+        used += SOIL_SENSOR_LOG_HEADER_SIZE + header.length;
+    }
+
+    return used;
+}
+
+void SoilSensorLog::push(uint32_t time, uint16_t moisture, int16_t temperature)
+{
+    soilSensorLogSample sample;
+
+    sample.time = time;
+    sample.moisture = moisture;
+    sample.temperature = temperature;
+
+    if (blocksCount == 0)
+    {
+        return;
+    }
+
+    if ((blocksUsed > 0) && !sealed && _append(&sample))
+    {
+        last = sample;
+
+        return;
+    }
+
+    if ((blocksUsed > 0) && !sealed && (blockPager != NULL))
+    {
+        blockPager(_block(blocksUsed - 1), SOIL_SENSOR_LOG_BLOCK_SIZE);
+    }
+
+    if (blocksUsed == blocksCount)
+    {
+        // Evicting the oldest block is just moving the start of the ring
+        blocksFirst = (blocksFirst + 1) % blocksCount;
+        blocksUsed--;
+    }
+
+    blocksUsed++;
+
+    soilSensorLogHeader header;
+
+    header.first = sample;
+    header.count = 1;
+    header.length = 0;
+
+    _writeHeader(_block(blocksUsed - 1), &header);
+
+    last = sample;
+    sealed = false;
+}
+
+void SoilSensorLog::rewind(soilSensorLogCursor *cursor)
+{
+    memset(cursor, 0, sizeof(soilSensorLogCursor));
+}
+
+bool SoilSensorLog::read(soilSensorLogCursor *cursor, soilSensorLogSample *sample)
+{
+    while (cursor->block < blocksUsed)
+    {
+        if (readBlock(_block(cursor->block), cursor, sample))
+        {
+            return true;
+        }
+
+        cursor->block++;
+        cursor->sample = 0;
+        cursor->offset = 0;
+    }
+
+    return false;
+}
+
+bool SoilSensorLog::readBlock(const uint8_t *block, soilSensorLogCursor *cursor, soilSensorLogSample *sample)
+{
+    soilSensorLogHeader header;
+
+    _readHeader(block, &header);
+
+    if (cursor->sample >= header.count)
+    {
+        return false;
+    }
+
+    if (cursor->sample == 0)
+    {
+        cursor->last = header.first;
+    }
+    else
+    {
+        const uint8_t *p = block + SOIL_SENSOR_LOG_HEADER_SIZE + cursor->offset;
+        int32_t delta;
+        uint8_t n;
+
+        n = _decode(p, &delta);
+        cursor->last.time += delta;
+        p += n;
+        cursor->offset += n;
+
+        n = _decode(p, &delta);
+        cursor->last.moisture += delta;
+        p += n;
+        cursor->offset += n;
+
+        n = _decode(p, &delta);
+        cursor->last.temperature += delta;
+        cursor->offset += n;
+    }
+
+    cursor->sample++;
+    *sample = cursor->last;
+
+    return true;
+}
+
+uint8_t *SoilSensorLog::_block(uint16_t index)
+{
+    return blocks + (size_t) ((blocksFirst + index) % blocksCount) * SOIL_SENSOR_LOG_BLOCK_SIZE;
+}
+
+bool SoilSensorLog::_append(const soilSensorLogSample *sample)
+{
+    uint8_t *block = _block(blocksUsed - 1);
+    soilSensorLogHeader header;
+
+    _readHeader(block, &header);
+
+    uint8_t buffer[15];
+    uint8_t n = 0;
+
+    n += _encode((int32_t) (sample->time - last.time), &buffer[n]);
+    n += _encode((int32_t) sample->moisture - last.moisture, &buffer[n]);
+    n += _encode((int32_t) sample->temperature - last.temperature, &buffer[n]);
+
+    if ((header.count == 0xff) || (SOIL_SENSOR_LOG_HEADER_SIZE + header.length + n > SOIL_SENSOR_LOG_BLOCK_SIZE))
+    {
+        return false;
+    }
+
+    memcpy(block + SOIL_SENSOR_LOG_HEADER_SIZE + header.length, buffer, n);
+
+    header.count++;
+    header.length += n;
+
+    _writeHeader(block, &header);
+
+    return true;
+}
+
+void SoilSensorLog::_readHeader(const uint8_t *block, soilSensorLogHeader *header)
+{
+    // Byte by byte, blocks may be unaligned, e.g. read back from flash into a byte buffer
+    header->first.time = (uint32_t) block[0] | (uint32_t) block[1] << 8 | (uint32_t) block[2] << 16 | (uint32_t) block[3] << 24;
+    header->first.moisture = block[4] | (uint16_t) block[5] << 8;
+    header->first.temperature = (int16_t) (block[6] | (uint16_t) block[7] << 8);
+    header->count = block[8];
+    header->length = block[9];
+}
+
+void SoilSensorLog::_writeHeader(uint8_t *block, const soilSensorLogHeader *header)
+{
+    block[0] = header->first.time;
+    block[1] = header->first.time >> 8;
+    block[2] = header->first.time >> 16;
+    block[3] = header->first.time >> 24;
+    block[4] = header->first.moisture;
+    block[5] = header->first.moisture >> 8;
+    block[6] = header->first.temperature;
+    block[7] = header->first.temperature >> 8;
+    block[8] = header->count;
+    block[9] = header->length;
+}
+
+uint8_t SoilSensorLog::_encode(int32_t value, uint8_t *buffer)
+{
+    // Zigzag keeps small negative deltas small
+    uint32_t v = ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+    uint8_t n = 0;
+
+    while (v >= 0x80)
+    {
+        buffer[n++] = (v & 0x7f) | 0x80;
+        v >>= 7;
+    }
+
+    buffer[n++] = v;
+
+    return n;
+}
+
+uint8_t SoilSensorLog::_decode(const uint8_t *buffer, int32_t *value)
+{
+    uint32_t v = 0;
+    uint8_t n = 0;
+
+    do
+    {
+        v |= (uint32_t) (buffer[n] & 0x7f) << (7 * n);
+    }
+    while (buffer[n++] & 0x80);
+
+    *value = (int32_t) (v >> 1) ^ -(int32_t) (v & 1);
+
+    return n;
+}
@@ -0,0 +1,207 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+Fixed-capacity log of samples for offline operation. Samples are stored as
+zigzag varint deltas in blocks, the oldest block is dropped when the log is full.
+
+*/
+#ifndef SoilSensorLog_h
+#define SoilSensorLog_h
+
+#include "Arduino.h"
+
+#ifndef SOIL_SENSOR_LOG_BLOCK_SIZE
+#define SOIL_SENSOR_LOG_BLOCK_SIZE 64
+#endif
+
+// Header is encoded field by field in little endian, so paged blocks are portable
+#define SOIL_SENSOR_LOG_HEADER_SIZE 10
+
+#if SOIL_SENSOR_LOG_BLOCK_SIZE - SOIL_SENSOR_LOG_HEADER_SIZE > 255
+#error "SOIL_SENSOR_LOG_BLOCK_SIZE leaves more than 255 bytes after the header"
+#endif
+
+/**
+ * @brief Logged sample.
+ */
+typedef struct
+{
+    uint32_t time;        //! @brief Coarse timestamp, e.g. seconds
+    uint16_t moisture;    //! @brief Raw moisture
+    int16_t temperature;  //! @brief Temperature in fixed-point 1/16 Celsius
+} soilSensorLogSample;
+
+/**
+ * @brief Header at the start of every block, followed by deltas of the next samples.
+ *        Stored as time, moisture and temperature of the first sample, count and length.
+ */
+typedef struct
+{
+    soilSensorLogSample first;  //! @brief First sample of the block
+    uint8_t count;              //! @brief Number of samples in the block
+    uint8_t length;             //! @brief Number of used bytes after the header
+} soilSensorLogHeader;
+
+/**
+ * @brief Position of streaming decoding.
+ */
+typedef struct
+{
+    uint16_t block;             //! @brief Block counted from the oldest one
+    uint8_t sample;             //! @brief Next sample in the block
+    uint8_t offset;             //! @brief Offset of the next sample after the header
+    soilSensorLogSample last;   //! @brief Previously decoded sample
+} soilSensorLogCursor;
+
+class SoilSensorLog
+{
+  public:
+    /**
+     * @brief       Constructor of SoilSensorLog class.
+     * @param[in]   buffer  storage, split into blocks of SOIL_SENSOR_LOG_BLOCK_SIZE bytes
+     * @param       size    size of the storage in bytes
+     */
+    SoilSensorLog(uint8_t *buffer, size_t size);
+    
+    /**
+     * @brief       Drop all samples.
+     */
+    void clear();
+    
+    /**
+     * @brief       Append sample, the oldest block is dropped if the log is full.
+     * @param       time          coarse timestamp
+     * @param       moisture      raw moisture
+     * @param       temperature   temperature in fixed-point 1/16 Celsius
+     */
+    void push(uint32_t time, uint16_t moisture, int16_t temperature);
+    
+    /**
+     * @brief       Set function called with every filled block, e.g. to write it to flash or EEPROM.
+     * @param       pager   function called with the block and its size
+     */
+    void setPager(void (*pager)(const uint8_t *block, size_t size));
+    
+    /**
+     * @brief       Pass the newest block to the pager before it is filled, e.g. before power down.
+     *              Next sample starts a new block, so every block is paged once.
+     * @return      True if a block was paged, false if there is no pager or no unpaged sample.
+     */
+    bool flush();
+    
+    /**
+     * @brief       Get number of logged samples.
+     * @return      Number of samples.
+     */
+    uint16_t count();
+    
+    /**
+     * @brief       Get number of used bytes including block headers.
+     * @return      Used bytes.
+     */
+    size_t length();
+    
+    /**
+     * @brief       Set cursor to the oldest sample.
+     * @param[out]  cursor  cursor to be set
+     */
+    void rewind(soilSensorLogCursor *cursor);
+    
+    /**
+     * @brief       Decode next sample, the log must not be pushed to while reading.
+     * @param       cursor  cursor set by rewind()
+     * @param[out]  sample  decoded sample
+     * @return      True if a sample was decoded, false after the newest sample.
+     */
+    bool read(soilSensorLogCursor *cursor, soilSensorLogSample *sample);
+    
+    /**
+     * @brief       Decode next sample of a single block, e.g. read back from flash.
+     * @param[in]   block   block passed to the pager
+     * @param       cursor  cursor zeroed before the first sample
+     * @param[out]  sample  decoded sample
+     * @return      True if a sample was decoded, false after the last sample of the block.
+     */
+    static bool readBlock(const uint8_t *block, soilSensorLogCursor *cursor, soilSensorLogSample *sample);
+    
+  private:
+    /**
+     * @brief       Storage of the blocks.
+     */
+    uint8_t *blocks;
+    
+    /**
+     * @brief       Number of blocks, index of the oldest block and number of used blocks.
+     */
+    uint16_t blocksCount;
+    uint16_t blocksFirst;
+    uint16_t blocksUsed;
+    
+    /**
+     * @brief       Last pushed sample.
+     */
+    soilSensorLogSample last;
+    
+    /**
+     * @brief       True if the newest block was paged by flush().
+     */
+    bool sealed;
+    
+    /**
+     * @brief       Function called with every filled block.
+     */
+    void (*blockPager)(const uint8_t *block, size_t size);
+    
+    /**
+     * @brief       Get block counted from the oldest one.
+     * @param       index   index of the block
+     * @return      Pointer to the block.
+     */
+    uint8_t *_block(uint16_t index);
+    
+    /**
+     * @brief       Append deltas of the sample to the newest block.
+     * @param[in]   sample  sample to be appended
+     * @return      True if the sample fits into the block, otherwise false.
+     */
+    bool _append(const soilSensorLogSample *sample);
+    
+    /**
+     * @brief       Decode block header.
+     * @param[in]   block   block
+     * @param[out]  header  decoded header
+     */
+    static void _readHeader(const uint8_t *block, soilSensorLogHeader *header);
+    
+    /**
+     * @brief       Encode block header.
+     * @param[out]  block   block
+     * @param[in]   header  header to be encoded
+     */
+    static void _writeHeader(uint8_t *block, const soilSensorLogHeader *header);
+    
+    /**
+     * @brief       Encode zigzag varint.
+     * @param       value   value to be encoded
+     * @param[out]  buffer  buffer for at least 5 bytes
+     * @return      Number of written bytes.
+     */
+    static uint8_t _encode(int32_t value, uint8_t *buffer);
+    
+    /**
+     * @brief       Decode zigzag varint.
+     * @param[in]   buffer  encoded value
+     * @param[out]  value   decoded value
+     * @return      Number of read bytes.
+     */
+    static uint8_t _decode(const uint8_t *buffer, int32_t *value);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "SoilSensorPoller.h"
+#include "Arduino.h"
+
+SoilSensorPoller::SoilSensorPoller()
+{
+    sensorsCount = 0;
+    pendingCount = 0;
+    cursor = 0;
+}
+
+bool SoilSensorPoller::add(SoilSensor *soilSensor)
+{
+    if (sensorsCount == SOIL_SENSOR_POLLER_MAX)
+    {
+        return false;
+    }
+
+    sensors[sensorsCount] = soilSensor;
+    pending[sensorsCount] = false;
+    sensorsCount++;
+
+    return true;
+}
+
+uint8_t SoilSensorPoller::count()
+{
+    return sensorsCount;
+}
+
+SoilSensor *SoilSensorPoller::getSensor(uint8_t slot)
+{
+    return sensors[slot];
+}
+
+void SoilSensorPoller::start()
+{
+    cursor = 0;
+    pendingCount = sensorsCount;
+
+    for (uint8_t i = 0; i < sensorsCount; i++)
+    {
+        pending[i] = true;
+
+        // A sensor which fails to start is finished and reported by next()
+        sensors[i]->startMeasurement();
+    }
+}
+
+bool SoilSensorPoller::readBatch(soilSensorBatch *batch)
+{
+    if (batch->count < sensorsCount)
+    {
+        return false;
+    }
+
+    bool success = true;
+    int8_t slot;
+
+    start();
+
+    while ((slot = next()) >= 0)
+    {
+        if (!sensors[slot]->getMeasurement(batch, slot))
+        {
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+int8_t SoilSensorPoller::next()
+{
+    while (pendingCount > 0)
+    {
+        uint8_t slot = cursor;
+
+        cursor = (cursor + 1) % sensorsCount;
+
+        if (!pending[slot])
+        {
+            continue;
+        }
+
+        if (sensors[slot]->process())
+        {
+            pending[slot] = false;
+            pendingCount--;
+
+            return slot;
+        }
+    }
+
+    return -1;
+}
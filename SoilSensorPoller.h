@@ -0,0 +1,91 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+Poller which measures sensors on several 1-Wire buses at once. While DS28E17 on
+one bus is busy with its I2C transaction, the other buses are served. Buses
+bit-banged by OneWire keep the CPU for every slot, so only the I2C transactions
+overlap, buses sending slots in the background such as OneWireUartBus run in
+parallel.
+
+*/
+#ifndef SoilSensorPoller_h
+#define SoilSensorPoller_h
+
+#include "Arduino.h"
+#include "SoilSensor.h"
+
+#define SOIL_SENSOR_POLLER_MAX 8
+
+class SoilSensorPoller
+{
+  public:
+    /**
+      * @brief       Constructor of SoilSensorPoller class.
+      */
+    SoilSensorPoller();
+    
+    /**
+     * @brief       Add sensor, every sensor has to be on its own 1-Wire bus.
+     * @param       soilSensor    sensor to be polled
+     * @return      True if added, false if SOIL_SENSOR_POLLER_MAX sensors were already added.
+     */
+    bool add(SoilSensor *soilSensor);
+    
+    /**
+     * @brief       Get number of added sensors.
+     * @return      Number of sensors.
+     */
+    uint8_t count();
+    
+    /**
+     * @brief       Get added sensor.
+     * @param       slot    index of the sensor in order of adding
+     * @return      Pointer to the sensor.
+     */
+    SoilSensor *getSensor(uint8_t slot);
+    
+    /**
+     * @brief       Start measurement on all sensors.
+     */
+    void start();
+    
+    /**
+     * @brief       Poll all buses until one of the sensors finishes its measurement.
+     * @return      Slot of the finished sensor, -1 if all sensors finished.
+     */
+    int8_t next();
+    
+    /**
+     * @brief       Measure all sensors and store results into batch arrays in order of completion.
+     * @param[out]  batch   batch arrays with at least count() slots, slot is the order of adding
+     * @return      True if all measurements were successful, otherwise false.
+     */
+    bool readBatch(soilSensorBatch *batch);
+    
+  private:
+    /**
+     * @brief       Polled sensors.
+     */
+    SoilSensor *sensors[SOIL_SENSOR_POLLER_MAX];
+    uint8_t sensorsCount;
+    
+    /**
+     * @brief       True for sensors with measurement in progress.
+     */
+    bool pending[SOIL_SENSOR_POLLER_MAX];
+    uint8_t pendingCount;
+    
+    /**
+     * @brief       Slot polled next, so no bus is starved.
+     */
+    uint8_t cursor;
+};
+
+#endif
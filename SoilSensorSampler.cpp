@@ -0,0 +1,169 @@
+#include "SoilSensorSampler.h"
+#include "Arduino.h"
+
+SoilSensorSampler::SoilSensorSampler(SoilSensor *soilSensor)
+{
+    sensor = soilSensor;
+    intervalMin = SOIL_SENSOR_SAMPLER_INTERVAL_MIN;
+    intervalMax = SOIL_SENSOR_SAMPLER_INTERVAL_MAX;
+    sampleInterval = intervalMin;
+    sampleTime = 0;
+    deadBandMoisture = SOIL_SENSOR_SAMPLER_DEAD_BAND_MOISTURE;
+    deadBandTemperature = SOIL_SENSOR_SAMPLER_DEAD_BAND_TEMPERATURE;
+    reportMoisture = SOIL_SENSOR_SAMPLER_REPORT_MOISTURE;
+    reportTemperature = SOIL_SENSOR_SAMPLER_REPORT_TEMPERATURE;
+    rapidMoisture = SOIL_SENSOR_SAMPLER_RAPID_MOISTURE;
+    rapidTemperature = SOIL_SENSOR_SAMPLER_RAPID_TEMPERATURE;
+    lastTime = 0;
+    lastMoisture = 0;
+    lastTemperature = 0;
+    reportedMoisture = 0;
+    reportedTemperature = 0;
+    sampled = false;
+    primed = false;
+}
+
+void SoilSensorSampler::setInterval(uint32_t min, uint32_t max)
+{
+    intervalMin = min;
+    intervalMax = max;
+
+    if (sampleInterval < intervalMin)
+    {
+        sampleInterval = intervalMin;
+    }
+
+    if (sampleInterval > intervalMax)
+    {
+        sampleInterval = intervalMax;
+    }
+}
+
+void SoilSensorSampler::setDeadBand(uint16_t moisture, float temperature)
+{
+    deadBandMoisture = moisture;
+    deadBandTemperature = temperature;
+}
+
+void SoilSensorSampler::setReportThreshold(uint16_t moisture, float temperature)
+{
+    reportMoisture = moisture;
+    reportTemperature = temperature;
+}
+
+void SoilSensorSampler::setRapidChange(uint16_t moisture, float temperature)
+{
+    rapidMoisture = moisture;
+    rapidTemperature = temperature;
+}
+
+uint32_t SoilSensorSampler::interval()
+{
+    return sampleInterval;
+}
+
+uint32_t SoilSensorSampler::timeToNext()
+{
+    if (!sampled)
+    {
+        return 0;
+    }
+
+    uint32_t elapsed = millis() - sampleTime;
+
+    return elapsed < sampleInterval ? sampleInterval - elapsed : 0;
+}
+
+bool SoilSensorSampler::update(uint16_t *moisture, float *temperature)
+{
+    if (sampled && timeToNext() != 0)
+    {
+        return false;
+    }
+
+    sampled = true;
+    sampleTime = millis();
+
+    uint16_t m;
+    float t;
+
+    sensor->wakeUp();
+
+    bool success = sensor->readTemperatureCelsius(&t) && sensor->readMoistureRaw(&m);
+
+    sensor->sleep();
+
+    if (!success)
+    {
+        // Retry soon, but do not count the failure as a change
+        sampleInterval = intervalMin;
+
+        return false;
+    }
+
+    if (!feed(m, t, sampleTime))
+    {
+        return false;
+    }
+
+    *moisture = m;
+    *temperature = t;
+
+    return true;
+}
+
+bool SoilSensorSampler::feed(uint16_t moisture, float temperature, uint32_t time)
+{
+    if (!primed)
+    {
+        primed = true;
+        sampleInterval = intervalMin;
+        lastTime = time;
+        lastMoisture = reportedMoisture = moisture;
+        lastTemperature = reportedTemperature = temperature;
+
+        return true;
+    }
+
+    uint16_t changeMoisture = moisture > lastMoisture ? moisture - lastMoisture : lastMoisture - moisture;
+    float changeTemperature = fabs(temperature - lastTemperature);
+
+    // Rate per minute, so a slow drift over a long interval is not taken for irrigation
+    float minutes = (uint32_t) (time - lastTime) / 60000.0;
+
+    if (minutes <= 0)
+    {
+        minutes = 1 / 60000.0;
+    }
+
+    lastTime = time;
+    lastMoisture = moisture;
+    lastTemperature = temperature;
+
+    if (changeMoisture <= deadBandMoisture && changeTemperature <= deadBandTemperature)
+    {
+        sampleInterval = sampleInterval > intervalMax / 2 ? intervalMax : sampleInterval * 2;
+    }
+    else if (changeMoisture / minutes >= rapidMoisture || changeTemperature / minutes >= rapidTemperature)
+    {
+        // Rapid change such as irrigation, follow it as closely as possible
+        sampleInterval = intervalMin;
+    }
+    else
+    {
+        sampleInterval = sampleInterval / 2 < intervalMin ? intervalMin : sampleInterval / 2;
+    }
+
+    uint16_t deltaMoisture = moisture > reportedMoisture ? moisture - reportedMoisture : reportedMoisture - moisture;
+    float deltaTemperature = fabs(temperature - reportedTemperature);
+
+    if (deltaMoisture < reportMoisture && deltaTemperature < reportTemperature)
+    {
+        return false;
+    }
+
+    reportedMoisture = moisture;
+    reportedTemperature = temperature;
+
+    return true;
+}
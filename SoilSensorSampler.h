@@ -0,0 +1,150 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+
+MIT License
+
+Adaptive sampler which reads the sensor less often while readings are stable,
+samples at the shortest interval while readings change faster than the rapid
+change rate and reports only readings which changed more than the reporting
+threshold.
+
+*/
+#ifndef SoilSensorSampler_h
+#define SoilSensorSampler_h
+
+#include "Arduino.h"
+#include "SoilSensor.h"
+
+#define SOIL_SENSOR_SAMPLER_INTERVAL_MIN 2000
+#define SOIL_SENSOR_SAMPLER_INTERVAL_MAX 300000
+#define SOIL_SENSOR_SAMPLER_DEAD_BAND_MOISTURE 16
+#define SOIL_SENSOR_SAMPLER_DEAD_BAND_TEMPERATURE 0.25
+#define SOIL_SENSOR_SAMPLER_REPORT_MOISTURE 32
+#define SOIL_SENSOR_SAMPLER_REPORT_TEMPERATURE 0.5
+#define SOIL_SENSOR_SAMPLER_RAPID_MOISTURE 32
+#define SOIL_SENSOR_SAMPLER_RAPID_TEMPERATURE 0.5
+
+class SoilSensorSampler
+{
+  public:
+    /**
+      * @brief       Constructor of SoilSensorSampler class.
+      * @param       soilSensor   sensor to be sampled
+      */
+    SoilSensorSampler(SoilSensor *soilSensor);
+    
+    /**
+     * @brief       Set range of the sampling interval.
+     * @param       min   shortest interval in milliseconds, used during rapid change
+     * @param       max   longest interval in milliseconds, reached while readings are stable
+     */
+    void setInterval(uint32_t min, uint32_t max);
+    
+    /**
+     * @brief       Set dead-band, change between samples within it lengthens the interval.
+     * @param       moisture      raw moisture dead-band
+     * @param       temperature   temperature dead-band in Celsius
+     */
+    void setDeadBand(uint16_t moisture, float temperature);
+    
+    /**
+     * @brief       Set reporting threshold, change since the last report above it is reported.
+     * @param       moisture      raw moisture threshold
+     * @param       temperature   temperature threshold in Celsius
+     */
+    void setReportThreshold(uint16_t moisture, float temperature);
+    
+    /**
+     * @brief       Set rapid change rate, change faster than it drops the interval to the shortest one.
+     * @param       moisture      raw moisture change per minute
+     * @param       temperature   temperature change in Celsius per minute
+     */
+    void setRapidChange(uint16_t moisture, float temperature);
+    
+    /**
+     * @brief       Sample the sensor if the interval elapsed, call it from loop().
+     * @param[out]  moisture      raw moisture to be reported
+     * @param[out]  temperature   temperature in Celsius to be reported
+     * @return      True if a reading should be reported, otherwise false.
+     */
+    bool update(uint16_t *moisture, float *temperature);
+    
+    /**
+     * @brief       Feed a reading to the sampling policy without touching the sensor.
+     * @param       moisture      raw moisture
+     * @param       temperature   temperature in Celsius
+     * @param       time          time of the reading in milliseconds
+     * @return      True if the reading crosses the reporting threshold, otherwise false.
+     */
+    bool feed(uint16_t moisture, float temperature, uint32_t time);
+    
+    /**
+     * @brief       Get current sampling interval.
+     * @return      Sampling interval in milliseconds.
+     */
+    uint32_t interval();
+    
+    /**
+     * @brief       Get time remaining to the next sample, e.g. for sleeping the MCU.
+     * @return      Time to the next sample in milliseconds.
+     */
+    uint32_t timeToNext();
+    
+  private:
+    /**
+     * @brief       Pointer to SoilSensor object.
+     */
+    SoilSensor *sensor;
+    
+    /**
+     * @brief       Shortest and longest sampling interval in milliseconds.
+     */
+    uint32_t intervalMin;
+    uint32_t intervalMax;
+    
+    /**
+     * @brief       Current sampling interval in milliseconds.
+     */
+    uint32_t sampleInterval;
+    
+    /**
+     * @brief       Time of the last sample in milliseconds.
+     */
+    uint32_t sampleTime;
+    
+    /**
+     * @brief       Dead-band, reporting threshold and rapid change rate per minute.
+     */
+    uint16_t deadBandMoisture;
+    float deadBandTemperature;
+    uint16_t reportMoisture;
+    float reportTemperature;
+    uint16_t rapidMoisture;
+    float rapidTemperature;
+    
+    /**
+     * @brief       Last sampled and last reported reading.
+     */
+    uint32_t lastTime;
+    uint16_t lastMoisture;
+    float lastTemperature;
+    uint16_t reportedMoisture;
+    float reportedTemperature;
+    
+    /**
+     * @brief       True after the first sample was taken.
+     */
+    bool sampled;
+    
+    /**
+     * @brief       True after the first reading was fed to the policy.
+     */
+    bool primed;
+};
+
+#endif
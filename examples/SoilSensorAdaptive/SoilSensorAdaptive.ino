@@ -0,0 +1,68 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses HARDWARIO Soil Sensor with adaptive sampling. The sensor is read less often while readings are stable and more often during rapid change. Only readings which changed more than the reporting threshold are printed on serial port in text format. 
+
+*/
+#include <OneWire.h>
+#include <SoilSensor.h>
+#include <SoilSensorSampler.h>
+
+// Add a 4k7 pull-up resistor to this pin
+#define SOIL_SENSOR_PIN 7
+
+OneWire oneWire(SOIL_SENSOR_PIN);
+SoilSensor soilSensor(&oneWire);
+SoilSensorSampler sampler(&soilSensor);
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor Adaptive Sampling Example");
+  
+  soilSensor.begin();
+
+  // Sample every 2 s during irrigation, at most every 5 min while stable
+  sampler.setInterval(2000, 300000);
+  sampler.setDeadBand(16, 0.25);
+  sampler.setReportThreshold(32, 0.5);
+
+  // Irrigation raises raw moisture by hundreds per minute, drying by a few per hour
+  sampler.setRapidChange(32, 0.5);
+}
+
+void loop()
+{
+  uint16_t moisture;
+  float temperature;
+
+  if (sampler.update(&moisture, &temperature))
+  {
+    Serial.print("Temperature:  ");
+    Serial.print(temperature);
+    Serial.println("°C");
+
+    Serial.print("Moisture:  ");
+    Serial.print(moisture);
+    Serial.println();
+
+    Serial.print("Next sample in:  ");
+    Serial.print(sampler.interval());
+    Serial.println(" ms");
+  }
+}
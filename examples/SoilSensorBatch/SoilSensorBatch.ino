@@ -0,0 +1,81 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses up to four HARDWARIO Soil Sensors on one pin. All sensors are read into arrays at once and the arrays are printed on serial port in text format. 
+
+*/
+#include <OneWire.h>
+#include <SoilSensor.h>
+#include <SoilSensorGroup.h>
+#include <SoilSensorExport.h>
+
+// Add a 4k7 pull-up resistor to this pin
+#define SOIL_SENSOR_PIN 7
+#define SOIL_SENSOR_COUNT 4
+
+OneWire oneWire(SOIL_SENSOR_PIN);
+SoilSensor soilSensor[SOIL_SENSOR_COUNT] = { SoilSensor(&oneWire), SoilSensor(&oneWire), SoilSensor(&oneWire), SoilSensor(&oneWire) };
+SoilSensorGroup group;
+
+uint16_t raw[SOIL_SENSOR_COUNT];
+uint8_t moisture[SOIL_SENSOR_COUNT];
+int16_t temperature[SOIL_SENSOR_COUNT];
+uint8_t status[SOIL_SENSOR_COUNT];
+uint32_t timestamp[SOIL_SENSOR_COUNT];
+
+soilSensorBatch batch = { SOIL_SENSOR_COUNT, raw, moisture, temperature, status, timestamp };
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor Batch Example");
+
+  uint8_t rom[SOIL_SENSOR_COUNT][8];
+  uint8_t found = 0;
+
+  // begin() restarts the search, so finish the enumeration first
+  oneWire.reset_search();
+
+  while ((found < SOIL_SENSOR_COUNT) && oneWire.search(rom[found]))
+  {
+    if (rom[found][0] == DS28E17_FAMILY)
+    {
+      found++;
+    }
+  }
+
+  for (uint8_t i = 0; i < found; i++)
+  {
+    if (soilSensor[group.count()].begin(rom[i]))
+    {
+      group.add(&soilSensor[group.count()]);
+    }
+  }
+}
+
+void loop()
+{
+  group.wakeUp();
+  group.readBatch(&batch);
+  group.sleep();
+
+  // Slot, timestamp, status, temperature, moisture in percent, raw moisture
+  SoilSensorExport::print(&batch, group.count(), Serial);
+
+  delay(2000); 
+}
@@ -0,0 +1,86 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses up to four HARDWARIO Soil Sensors on one pin. Sensors are woken up, put to sleep and triggered for temperature conversion all at once. Measured data are printed on serial port in text format. 
+
+*/
+#include <OneWire.h>
+#include <SoilSensor.h>
+#include <SoilSensorGroup.h>
+
+// Add a 4k7 pull-up resistor to this pin
+#define SOIL_SENSOR_PIN 7
+#define SOIL_SENSOR_COUNT 4
+
+OneWire oneWire(SOIL_SENSOR_PIN);
+SoilSensor soilSensor[SOIL_SENSOR_COUNT] = { SoilSensor(&oneWire), SoilSensor(&oneWire), SoilSensor(&oneWire), SoilSensor(&oneWire) };
+SoilSensorGroup group;
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor Group Example");
+
+  uint8_t rom[SOIL_SENSOR_COUNT][8];
+  uint8_t found = 0;
+
+  // begin() restarts the search, so finish the enumeration first
+  oneWire.reset_search();
+
+  while ((found < SOIL_SENSOR_COUNT) && oneWire.search(rom[found]))
+  {
+    if (rom[found][0] == DS28E17_FAMILY)
+    {
+      found++;
+    }
+  }
+
+  for (uint8_t i = 0; i < found; i++)
+  {
+    SoilSensor *sensor = &soilSensor[group.count()];
+
+    if (sensor->begin(rom[i]))
+    {
+      group.add(sensor);
+    }
+  }
+}
+
+void loop()
+{
+  group.wakeUp();
+
+  float temperature[SOIL_SENSOR_COUNT];
+  group.readTemperatureCelsius(temperature);
+
+  for (uint8_t i = 0; i < group.count(); i++)
+  {
+    uint16_t moisture;
+    group.getSensor(i)->readMoistureRaw(&moisture);
+
+    Serial.print("Sensor ");
+    Serial.print(i);
+    Serial.print(":  ");
+    Serial.print(temperature[i]);
+    Serial.print("°C  ");
+    Serial.println(moisture);
+  }
+
+  group.sleep();
+  delay(2000); 
+}
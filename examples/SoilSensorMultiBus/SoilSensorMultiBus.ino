@@ -0,0 +1,88 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses three HARDWARIO Soil Sensors, each on its own pin. The sensors are measured at once and the results are printed on serial port in text format in the order in which the sensors finished. 
+
+*/
+#include <OneWire.h>
+#include <SoilSensor.h>
+#include <SoilSensorPoller.h>
+
+// Add a 4k7 pull-up resistor to each pin
+OneWire oneWireA(5);
+OneWire oneWireB(6);
+OneWire oneWireC(7);
+
+SoilSensor soilSensorA(&oneWireA);
+SoilSensor soilSensorB(&oneWireB);
+SoilSensor soilSensorC(&oneWireC);
+
+SoilSensorPoller poller;
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor Multiple Bus Example");
+  
+  soilSensorA.begin();
+  soilSensorB.begin();
+  soilSensorC.begin();
+
+  poller.add(&soilSensorA);
+  poller.add(&soilSensorB);
+  poller.add(&soilSensorC);
+}
+
+void loop()
+{
+  for (uint8_t i = 0; i < poller.count(); i++)
+  {
+    poller.getSensor(i)->wakeUp();
+  }
+
+  poller.start();
+
+  int8_t slot;
+
+  while ((slot = poller.next()) >= 0)
+  {
+    uint16_t moisture;
+    float temperature;
+
+    Serial.print("Sensor ");
+    Serial.print(slot);
+    Serial.print(":  ");
+
+    if (!poller.getSensor(slot)->getMeasurement(&moisture, &temperature))
+    {
+      Serial.println("error");
+      continue;
+    }
+
+    Serial.print(temperature);
+    Serial.print("°C  ");
+    Serial.println(moisture);
+  }
+
+  for (uint8_t i = 0; i < poller.count(); i++)
+  {
+    poller.getSensor(i)->sleep();
+  }
+
+  delay(2000); 
+}
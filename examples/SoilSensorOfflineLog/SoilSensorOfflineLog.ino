@@ -0,0 +1,80 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses HARDWARIO Soil Sensor for soil moisture and temperature measurement. Measured data are stored in compressed log in RAM and printed on serial port in text format when "d" is received. 
+
+*/
+#include <OneWire.h>
+#include <SoilSensor.h>
+#include <SoilSensorLog.h>
+
+// Add a 4k7 pull-up resistor to this pin
+#define SOIL_SENSOR_PIN 7
+
+OneWire oneWire(SOIL_SENSOR_PIN);
+SoilSensor soilSensor(&oneWire);
+
+uint8_t logBuffer[16 * SOIL_SENSOR_LOG_BLOCK_SIZE];
+SoilSensorLog sampleLog(logBuffer, sizeof(logBuffer));
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor Offline Log Example");
+  
+  soilSensor.begin();
+}
+
+void loop()
+{
+  soilSensor.wakeUp();
+  
+  int16_t temperature;
+  uint16_t moisture;
+
+  if (soilSensor.readTemperatureRaw(&temperature) && soilSensor.readMoistureRaw(&moisture))
+  {
+    sampleLog.push(millis() / 1000, moisture, temperature);
+  }
+   
+  soilSensor.sleep();
+
+  if (Serial.read() == 'd')
+  {
+    soilSensorLogCursor cursor;
+    soilSensorLogSample sample;
+
+    sampleLog.rewind(&cursor);
+
+    while (sampleLog.read(&cursor, &sample))
+    {
+      Serial.print(sample.time);
+      Serial.print(" ");
+      Serial.print(sample.temperature * 0.0625);
+      Serial.print(" ");
+      Serial.println(sample.moisture);
+    }
+
+    Serial.print(sampleLog.count());
+    Serial.print(" samples in ");
+    Serial.print(sampleLog.length());
+    Serial.println(" bytes");
+  }
+
+  delay(2000); 
+}
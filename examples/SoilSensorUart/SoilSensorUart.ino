@@ -0,0 +1,81 @@
+/*
+
+Soil Moisture Sensor
+====================
+
+Arduino Library for HARDWARIO Soil Sensor
+Author: podija https://github.com/podija
+        hubmartin https://github.com/hubmartin
+
+HARDWARIO is a digital maker kit developed by https://www.hardwario.com/
+
+Product: https://shop.hardwario.com/soil-sensor/
+Specs: https://developers.bigclown.com/hardware/about-soil-moisture-sensor
+Firmware: https://developers.bigclown.com/firmware/how-to-soil-moisture-sensor
+Forum: https://forum.bigclown.com/
+
+MIT License
+
+This example uses HARDWARIO Soil Sensor connected to a second UART instead of a bit-banged pin, for boards with Serial1. The measurement runs in the background while loop() keeps going, measured data are printed on serial port in text format. 
+
+*/
+#include <OneWire.h>
+#include <OneWireUart.h>
+#include <SoilSensor.h>
+
+// Join TX1 and RX1 to the sensor line through a Schottky diode (cathode to TX1)
+// and add a 4k7 pull-up resistor to the line
+OneWireUartBus oneWireUart(&Serial1);
+SoilSensor soilSensor(&oneWireUart);
+
+bool measuring = false;
+uint32_t lastMeasurement = 0;
+unsigned long idleLoops = 0;
+
+void setup() 
+{
+  Serial.begin(9600);
+  Serial.println("HARDWARIO Soil Sensor UART Example");
+  
+  oneWireUart.begin();
+  soilSensor.begin();
+}
+
+void loop()
+{
+  if (!measuring && (millis() - lastMeasurement >= 2000))
+  {
+    soilSensor.wakeUp();
+    measuring = soilSensor.startMeasurement();
+    lastMeasurement = millis();
+    idleLoops = 0;
+  }
+
+  // Slots of the request are sent by the UART while process() returns at once
+  if (measuring && soilSensor.process())
+  {
+    measuring = false;
+
+    uint16_t moisture;
+    float temperature;
+
+    if (soilSensor.getMeasurement(&moisture, &temperature))
+    {
+      Serial.print("Temperature:  ");
+      Serial.print(temperature);
+      Serial.println("°C");
+
+      Serial.print("Moisture:  ");
+      Serial.print(moisture);
+      Serial.println();
+    }
+
+    Serial.print("Loops during measurement:  ");
+    Serial.println(idleLoops);
+
+    soilSensor.sleep();
+  }
+
+  // Other work of the application goes here
+  idleLoops++;
+}
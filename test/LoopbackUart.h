@@ -0,0 +1,361 @@
+/*
+
+Loopback model of a UART whose TX and RX are joined to a 1-Wire line for the
+host tests of OneWireUartBus. Every call costs the CPU a microsecond, written
+bytes leave the transmit buffer one after another at the set baud rate and
+their echo, as pulled by the simulated devices, lands in the receive buffer.
+Devices answer reset, Search ROM, Match ROM, Skip ROM and function 0xBE, which
+reads two bytes derived from the ROM. A bridge device passes the slots after
+Match ROM to a sensor of SimulatedBus, so the whole driver runs over the line.
+
+*/
+#ifndef LoopbackUart_h
+#define LoopbackUart_h
+
+#include "Arduino.h"
+#include <OneWire.h>
+#include "SimulatedBus.h"
+
+#define LOOPBACK_UART_BUFFER 64
+#define LOOPBACK_UART_DEVICES 8
+#define LOOPBACK_UART_FUNCTION 0xBE
+
+typedef enum
+{
+    LOOPBACK_DEVICE_IDLE,
+    LOOPBACK_DEVICE_ROM_COMMAND,
+    LOOPBACK_DEVICE_SEARCH,
+    LOOPBACK_DEVICE_MATCH,
+    LOOPBACK_DEVICE_FUNCTION,
+    LOOPBACK_DEVICE_RESPOND,
+    LOOPBACK_DEVICE_BRIDGE
+} loopbackDeviceState;
+
+typedef struct
+{
+    uint8_t rom[8];
+    loopbackDeviceState state;
+    uint8_t bit;                //! @brief Bit of the current command, ROM or response
+    uint8_t phase;              //! @brief Slot of the search triplet
+    uint8_t command;
+    uint8_t response[2];
+    SimulatedBus *bridge;       //! @brief Bus with the sensor of the same ROM, NULL for a plain device
+} loopbackDevice;
+
+class LoopbackUart : public HardwareSerial
+{
+  public:
+    loopbackDevice devices[LOOPBACK_UART_DEVICES];
+    uint8_t devicesCount;
+    bool looped;                //! @brief False if RX is not joined to the line
+    uint32_t overflows;         //! @brief Echoes lost because the receive buffer was full
+
+    LoopbackUart()
+    {
+        devicesCount = 0;
+        looped = true;
+        overflows = 0;
+        baud = 0;
+        txLength = 0;
+        rxHead = 0;
+        rxLength = 0;
+        lineFree = 0;
+    }
+
+    loopbackDevice *add(uint8_t family, uint8_t id)
+    {
+        loopbackDevice *device = &devices[devicesCount++];
+
+        uint8_t rom[8] = { family, id, 0x5A, 0, 0, 0, 0, 0 };
+        rom[7] = OneWire::crc8(rom, 7);
+
+        memcpy(device->rom, rom, sizeof(rom));
+        device->state = LOOPBACK_DEVICE_IDLE;
+        device->bridge = NULL;
+
+        return device;
+    }
+
+    loopbackDevice *addBridge(SimulatedBus *bus, simulatedSensor *sensor)
+    {
+        loopbackDevice *device = add(0, 0);
+
+        memcpy(device->rom, sensor->rom, sizeof(device->rom));
+        device->bridge = bus;
+
+        return device;
+    }
+
+    void begin(unsigned long speed)
+    {
+        _advance();
+        baud = speed;
+    }
+
+    void end()
+    {
+    }
+
+    int available()
+    {
+        _advance();
+
+        return rxLength;
+    }
+
+    int read()
+    {
+        _advance();
+
+        if (rxLength == 0)
+        {
+            return -1;
+        }
+
+        uint8_t v = rx[rxHead];
+
+        rxHead = (rxHead + 1) % LOOPBACK_UART_BUFFER;
+        rxLength--;
+
+        return v;
+    }
+
+    int peek()
+    {
+        _advance();
+
+        return rxLength > 0 ? rx[rxHead] : -1;
+    }
+
+    void flush()
+    {
+        _advance();
+
+        if ((long) (lineFree - testMicros) > 0)
+        {
+            testMicros = lineFree;
+        }
+
+        _advance();
+    }
+
+    int availableForWrite()
+    {
+        _advance();
+
+        return LOOPBACK_UART_BUFFER - txLength;
+    }
+
+    size_t write(uint8_t value)
+    {
+        _advance();
+
+        // Like the Arduino core, a full transmit buffer blocks
+        while (txLength == LOOPBACK_UART_BUFFER)
+        {
+            _advance();
+        }
+
+        unsigned long start = (long) (lineFree - testMicros) > 0 ? lineFree : testMicros;
+
+        lineFree = start + 10000000UL / baud;
+        tx[txLength] = value;
+        txEnd[txLength] = lineFree;
+        txBaud[txLength] = baud;
+        txLength++;
+
+        return 1;
+    }
+
+    using Print::write;
+
+  private:
+    unsigned long baud;
+    uint8_t tx[LOOPBACK_UART_BUFFER];
+    unsigned long txEnd[LOOPBACK_UART_BUFFER];
+    unsigned long txBaud[LOOPBACK_UART_BUFFER];
+    uint8_t txLength;
+    uint8_t rx[LOOPBACK_UART_BUFFER];
+    uint8_t rxHead;
+    uint8_t rxLength;
+    unsigned long lineFree;
+
+    void _advance()
+    {
+        testMicros++;
+
+        while ((txLength > 0) && ((long) (testMicros - txEnd[0]) >= 0))
+        {
+            uint8_t echo = _line(tx[0], txBaud[0]);
+
+            txLength--;
+            memmove(tx, tx + 1, txLength);
+            memmove(txEnd, txEnd + 1, txLength * sizeof(txEnd[0]));
+            memmove(txBaud, txBaud + 1, txLength * sizeof(txBaud[0]));
+
+            if (!looped)
+            {
+                continue;
+            }
+
+            if (rxLength == LOOPBACK_UART_BUFFER)
+            {
+                overflows++;
+                continue;
+            }
+
+            rx[(rxHead + rxLength) % LOOPBACK_UART_BUFFER] = echo;
+            rxLength++;
+        }
+    }
+
+    uint8_t _line(uint8_t value, unsigned long speed)
+    {
+        if (speed < 115200)
+        {
+            bool presence = false;
+
+            for (uint8_t i = 0; i < devicesCount; i++)
+            {
+                devices[i].state = LOOPBACK_DEVICE_ROM_COMMAND;
+                devices[i].bit = 0;
+                devices[i].command = 0;
+                presence = true;
+
+                if (devices[i].bridge != NULL)
+                {
+                    devices[i].bridge->release();
+                }
+            }
+
+            return presence ? 0xE0 : value;
+        }
+
+        uint8_t master = value == 0xFF ? 1 : 0;
+        uint8_t line = master;
+
+        for (uint8_t i = 0; i < devicesCount; i++)
+        {
+            line &= _slot(&devices[i], master);
+        }
+
+        // A slot pulled low by a device is echoed shortened
+        return master && !line ? 0xFE : value;
+    }
+
+    static uint8_t _romBit(loopbackDevice *device)
+    {
+        return (device->rom[device->bit / 8] >> (device->bit % 8)) & 0x01;
+    }
+
+    static uint8_t _slot(loopbackDevice *device, uint8_t master)
+    {
+        uint8_t drive = 1;
+
+        switch (device->state)
+        {
+            case LOOPBACK_DEVICE_IDLE:
+                break;
+
+            case LOOPBACK_DEVICE_ROM_COMMAND:
+                device->command |= master << device->bit;
+
+                if (++device->bit == 8)
+                {
+                    device->bit = 0;
+                    device->phase = 0;
+                    device->state = device->command == 0xF0 ? LOOPBACK_DEVICE_SEARCH :
+                                    device->command == 0x55 ? LOOPBACK_DEVICE_MATCH :
+                                    device->command == 0xCC ? LOOPBACK_DEVICE_FUNCTION : LOOPBACK_DEVICE_IDLE;
+                    device->command = 0;
+                }
+                break;
+
+            case LOOPBACK_DEVICE_SEARCH:
+                if (device->phase < 2)
+                {
+                    drive = device->phase == 0 ? _romBit(device) : !_romBit(device);
+                    device->phase++;
+                    break;
+                }
+
+                device->phase = 0;
+
+                if (master != _romBit(device))
+                {
+                    device->state = LOOPBACK_DEVICE_IDLE;
+                }
+                else if (++device->bit == 64)
+                {
+                    device->bit = 0;
+                    device->state = LOOPBACK_DEVICE_FUNCTION;
+                }
+                break;
+
+            case LOOPBACK_DEVICE_MATCH:
+                if (master != _romBit(device))
+                {
+                    device->state = LOOPBACK_DEVICE_IDLE;
+                }
+                else if (++device->bit == 64)
+                {
+                    device->bit = 0;
+                    device->command = 0;
+                    device->state = device->bridge != NULL ? LOOPBACK_DEVICE_BRIDGE : LOOPBACK_DEVICE_FUNCTION;
+
+                    if (device->bridge != NULL)
+                    {
+                        device->bridge->attach(device->rom);
+                    }
+                }
+                break;
+
+            case LOOPBACK_DEVICE_FUNCTION:
+                device->command |= master << device->bit;
+
+                if (++device->bit == 8)
+                {
+                    device->bit = 0;
+                    device->response[0] = device->rom[1];
+                    device->response[1] = ~device->rom[1];
+                    device->state = device->command == LOOPBACK_UART_FUNCTION ? LOOPBACK_DEVICE_RESPOND : LOOPBACK_DEVICE_IDLE;
+                }
+                break;
+
+            case LOOPBACK_DEVICE_RESPOND:
+                drive = (device->response[device->bit / 8] >> (device->bit % 8)) & 0x01;
+
+                if (++device->bit == 16)
+                {
+                    device->state = LOOPBACK_DEVICE_IDLE;
+                }
+                break;
+
+            case LOOPBACK_DEVICE_BRIDGE:
+            {
+                // Slots are read while the bridge has something to say, otherwise they are written
+                int answer = device->bridge->answer();
+
+                if (answer >= 0)
+                {
+                    drive = answer;
+                    break;
+                }
+
+                device->command |= master << device->bit;
+
+                if (++device->bit == 8)
+                {
+                    device->bridge->feed(device->command);
+                    device->bit = 0;
+                    device->command = 0;
+                }
+                break;
+            }
+        }
+
+        return drive;
+    }
+};
+
+#endif
@@ -0,0 +1,413 @@
+/*
+
+Simulated 1-Wire bus with DS28E17 bridges of soil sensors for the host tests.
+Every operation advances testMicros by the timing of the OneWire library, a
+bridge stays busy for busyTime after a request and answers ZSSC3123, TMP112
+and (erased) EEPROM. Sleep and TMP112 conversion triggers are counted for the
+selected bridge and, after Skip ROM, for all of them. A reset wakes all.
+
+*/
+#ifndef SimulatedBus_h
+#define SimulatedBus_h
+
+#include "Arduino.h"
+#include "SoilSensor.h"
+
+#define SIMULATED_BUS_DEVICES 16
+
+// Read Configuration from the datasheet, not from the driver, so a wrong command of the driver is caught
+#define SIMULATED_BUS_READ_CONFIG 0xE1
+
+typedef struct
+{
+    uint8_t rom[8];
+    bool present;
+    uint16_t moisture;          //! @brief ZSSC3123 raw data including status bits
+    int16_t temperature;        //! @brief TMP112 temperature in 1/16 Celsius
+    uint32_t busyTime;          //! @brief I2C transaction time in microseconds
+    uint8_t status;             //! @brief DS28E17 status returned by every transaction
+    uint8_t missedSelects;      //! @brief Number of next selects ignored, e.g. by a waking bridge
+    bool asleep;                //! @brief Sleep mode enabled and no reset since
+    uint32_t conversions;       //! @brief TMP112 one-shot conversions triggered
+} simulatedSensor;
+
+class SimulatedBus : public OneWireBus
+{
+  public:
+    simulatedSensor sensors[SIMULATED_BUS_DEVICES];
+    uint8_t sensorsCount;
+    uint32_t resets;
+    uint32_t selects;
+    uint32_t skips;
+    uint32_t eepromReads;
+
+    SimulatedBus()
+    {
+        sensorsCount = 0;
+        resets = 0;
+        selects = 0;
+        skips = 0;
+        eepromReads = 0;
+        reset_search();
+        _deselect();
+    }
+
+    simulatedSensor *add(uint8_t id, uint16_t moisture, int16_t temperature)
+    {
+        simulatedSensor *sensor = &sensors[sensorsCount++];
+
+        uint8_t rom[8] = { 0x19, id, 0, 0, 0, 0, 0x10, 0 };
+        rom[7] = OneWire::crc8(rom, 7);
+
+        memcpy(sensor->rom, rom, sizeof(rom));
+        sensor->present = true;
+        sensor->moisture = moisture;
+        sensor->temperature = temperature;
+        sensor->busyTime = 3000;
+        sensor->status = 0;
+        sensor->missedSelects = 0;
+        sensor->asleep = false;
+        sensor->conversions = 0;
+
+        return sensor;
+    }
+
+    uint8_t reset()
+    {
+        testMicros += 960;
+        resets++;
+        _deselect();
+
+        for (uint8_t i = 0; i < sensorsCount; i++)
+        {
+            sensors[i].asleep = false;
+        }
+
+        for (uint8_t i = 0; i < sensorsCount; i++)
+        {
+            if (sensors[i].present)
+            {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    void select(const uint8_t rom[8])
+    {
+        testMicros += 9 * 560;
+        selects++;
+        attach(rom);
+    }
+
+    /**
+     * @brief Slot level access for LoopbackUart, these spend no time: Match ROM, written byte and next answered bit.
+     */
+    void attach(const uint8_t rom[8])
+    {
+        _deselect();
+
+        for (uint8_t i = 0; i < sensorsCount; i++)
+        {
+            if (sensors[i].present && (memcmp(sensors[i].rom, rom, 8) == 0))
+            {
+                if (sensors[i].missedSelects > 0)
+                {
+                    sensors[i].missedSelects--;
+                }
+                else
+                {
+                    selected = i;
+                }
+            }
+        }
+    }
+
+    void skip()
+    {
+        testMicros += 560;
+        skips++;
+        _deselect();
+        broadcast = true;
+    }
+
+    void write(uint8_t v)
+    {
+        testMicros += 560;
+        feed(v);
+    }
+
+    void feed(uint8_t v)
+    {
+        if (commandLength < sizeof(command))
+        {
+            command[commandLength++] = v;
+        }
+
+        _process();
+    }
+
+    int answer()
+    {
+        if ((selected < 0) || (responsePosition >= responseLength))
+        {
+            return -1;
+        }
+
+        // Busy bits until the I2C transaction ends, then one ready bit before the status
+        if (busyUntil != 0)
+        {
+            if ((long) (testMicros - busyUntil) < 0)
+            {
+                return 1;
+            }
+
+            busyUntil = 0;
+
+            return 0;
+        }
+
+        uint8_t bit = (response[responsePosition] >> responseBit) & 0x01;
+
+        if (++responseBit == 8)
+        {
+            responseBit = 0;
+            responsePosition++;
+        }
+
+        return bit;
+    }
+
+    void release()
+    {
+        _deselect();
+    }
+
+    void write_bytes(const uint8_t *buf, uint16_t count)
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            write(buf[i]);
+        }
+    }
+
+    uint8_t read()
+    {
+        testMicros += 560;
+
+        if ((selected < 0) || (responsePosition >= responseLength))
+        {
+            return 0xff;
+        }
+
+        return response[responsePosition++];
+    }
+
+    uint8_t read_bit()
+    {
+        testMicros += 70;
+
+        if (selected < 0)
+        {
+            return 1;
+        }
+
+        return (long) (testMicros - busyUntil) < 0 ? 1 : 0;
+    }
+
+    void depower()
+    {
+    }
+
+    void reset_search()
+    {
+        searchFamily = 0;
+        searchIndex = 0;
+    }
+
+    void target_search(uint8_t family)
+    {
+        searchFamily = family;
+        searchIndex = 0;
+    }
+
+    bool search(uint8_t *rom)
+    {
+        testMicros += 14320;
+
+        while (searchIndex < sensorsCount)
+        {
+            simulatedSensor *sensor = &sensors[searchIndex++];
+
+            if (sensor->present && ((searchFamily == 0) || (sensor->rom[0] == searchFamily)))
+            {
+                memcpy(rom, sensor->rom, 8);
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+  private:
+    int selected;
+    bool broadcast;
+    uint8_t command[40];
+    uint8_t commandLength;
+    uint8_t response[40];
+    uint8_t responseLength;
+    uint8_t responsePosition;
+    uint8_t responseBit;
+    unsigned long busyUntil;
+    uint8_t searchFamily;
+    uint8_t searchIndex;
+
+    void _deselect()
+    {
+        selected = -1;
+        broadcast = false;
+        commandLength = 0;
+        responseLength = 0;
+        responsePosition = 0;
+        responseBit = 0;
+        busyUntil = 0;
+    }
+
+    void _respond(uint8_t i2cAddress, uint8_t length)
+    {
+        simulatedSensor *sensor = &sensors[selected];
+        uint8_t data[2] = { 0xff, 0xff };
+
+        if (i2cAddress == ZSSC3123_ADDRESS)
+        {
+            data[0] = sensor->moisture >> 8;
+            data[1] = sensor->moisture;
+        }
+        else if (i2cAddress == TMP112_ADDRESS)
+        {
+            uint16_t value = (uint16_t) sensor->temperature << 4;
+            data[0] = value >> 8;
+            data[1] = value;
+        }
+        else if (i2cAddress == EEPROM_ADDRESS)
+        {
+            eepromReads++;
+        }
+
+        for (uint8_t i = 0; i < length; i++)
+        {
+            response[responseLength++] = i < sizeof(data) ? data[i] : 0xff;
+        }
+    }
+
+    void _start(uint8_t writeStatus)
+    {
+        simulatedSensor *sensor = &sensors[selected];
+
+        busyUntil = testMicros + sensor->busyTime;
+        response[responseLength++] = sensor->status;
+
+        if (writeStatus)
+        {
+            response[responseLength++] = 0;
+        }
+    }
+
+    bool _isWritten()
+    {
+        return (command[0] == DS28E17_WRITE) && (commandLength > 3) && (commandLength == 3 + command[2] + 2);
+    }
+
+    void _written(simulatedSensor *sensor)
+    {
+        // One-shot bit of the TMP112 configuration starts a conversion
+        if (((command[1] >> 1) == TMP112_ADDRESS) && (command[2] > 1) && (command[3] == TMP112_REGISTER) && (command[4] & 0x80))
+        {
+            sensor->conversions++;
+        }
+    }
+
+    void _broadcast()
+    {
+        bool sleep = (command[0] == DS28E17_ENABLE_SLEEP) && (commandLength == 1);
+        bool written = _isWritten();
+
+        // Every present bridge executes the command, none of the answers is read
+        for (uint8_t i = 0; i < sensorsCount; i++)
+        {
+            if (!sensors[i].present)
+            {
+                continue;
+            }
+
+            if (sleep)
+            {
+                sensors[i].asleep = true;
+            }
+
+            if (written)
+            {
+                _written(&sensors[i]);
+            }
+        }
+    }
+
+    void _process()
+    {
+        if (broadcast)
+        {
+            _broadcast();
+            return;
+        }
+
+        if (selected < 0)
+        {
+            return;
+        }
+
+        switch (command[0])
+        {
+            case SIMULATED_BUS_READ_CONFIG:
+                if (commandLength == 1)
+                {
+                    response[responseLength++] = 0x01;
+                }
+                break;
+
+            case DS28E17_ENABLE_SLEEP:
+                if (commandLength == 1)
+                {
+                    sensors[selected].asleep = true;
+                }
+                break;
+
+            case DS28E17_WRITE:
+                if (_isWritten())
+                {
+                    _start(true);
+                    _written(&sensors[selected]);
+                }
+                break;
+
+            case DS28E17_READ:
+                if (commandLength == 5)
+                {
+                    _start(false);
+                    _respond(command[1] >> 1, command[2]);
+                }
+                break;
+
+            case DS28E17_MEMMORY_READ:
+                if ((commandLength > 3) && (commandLength == 3 + command[2] + 1 + 2))
+                {
+                    _start(true);
+                    _respond(command[1] >> 1, command[3 + command[2]]);
+                }
+                break;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+
+Host stub of the Arduino core, just enough to build the library on a PC.
+
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define HEX 16
+#define BIN 2
+
+typedef bool boolean;
+
+/**
+ * @brief Simulated time in microseconds, micros() advances it on every call so busy loops end.
+ */
+extern unsigned long testMicros;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class Print
+{
+  public:
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t length);
+
+    size_t print(const char *value);
+    size_t print(char value);
+    size_t print(int value, int base = 10);
+    size_t print(unsigned int value, int base = 10);
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int digits = 2);
+    size_t println(void);
+    size_t println(const char *value);
+    size_t println(int value, int base = 10);
+    size_t println(unsigned long value, int base = 10);
+    size_t println(double value, int digits = 2);
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream
+{
+  public:
+    virtual void begin(unsigned long baud);
+    virtual void end();
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+    virtual void flush();
+    virtual int availableForWrite();
+    virtual size_t write(uint8_t value);
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,184 @@
+#include "Arduino.h"
+#include <OneWire.h>
+#include <stdio.h>
+
+unsigned long testMicros = 0;
+
+unsigned long millis(void)
+{
+    return testMicros / 1000;
+}
+
+unsigned long micros(void)
+{
+    return testMicros++;
+}
+
+void delay(unsigned long ms)
+{
+    testMicros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    testMicros += us;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t length)
+{
+    size_t n = 0;
+
+    while (length--)
+    {
+        n += write(*buffer++);
+    }
+
+    return n;
+}
+
+size_t Print::print(const char *value)
+{
+    return write((const uint8_t *) value, strlen(value));
+}
+
+size_t Print::print(char value)
+{
+    return write((uint8_t) value);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long) value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long) value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    char buffer[24];
+
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%ld", value);
+
+    return print(buffer);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char buffer[24];
+
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%lu", value);
+
+    return print(buffer);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+
+    return print(buffer);
+}
+
+size_t Print::println(void)
+{
+    return print("\r\n");
+}
+
+size_t Print::println(const char *value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits)
+{
+    return print(value, digits) + println();
+}
+
+void HardwareSerial::begin(unsigned long) {}
+void HardwareSerial::end() {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+void HardwareSerial::flush() {}
+int HardwareSerial::availableForWrite() { return 64; }
+size_t HardwareSerial::write(uint8_t) { return 1; }
+
+HardwareSerial Serial;
+
+OneWire::OneWire(uint8_t) {}
+uint8_t OneWire::reset(void) { return 0; }
+void OneWire::select(const uint8_t *) {}
+void OneWire::skip(void) {}
+void OneWire::write(uint8_t, uint8_t) {}
+void OneWire::write_bytes(const uint8_t *, uint16_t, bool) {}
+uint8_t OneWire::read(void) { return 0xff; }
+void OneWire::read_bytes(uint8_t *buf, uint16_t count) { memset(buf, 0xff, count); }
+void OneWire::write_bit(uint8_t) {}
+uint8_t OneWire::read_bit(void) { return 1; }
+void OneWire::depower(void) {}
+void OneWire::reset_search() {}
+void OneWire::target_search(uint8_t) {}
+bool OneWire::search(uint8_t *, bool) { return false; }
+
+uint8_t OneWire::crc8(const uint8_t *addr, uint8_t len)
+{
+    uint8_t crc = 0;
+
+    while (len--)
+    {
+        uint8_t inbyte = *addr++;
+
+        for (uint8_t i = 8; i; i--)
+        {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+
+            if (mix)
+            {
+                crc ^= 0x8C;
+            }
+
+            inbyte >>= 1;
+        }
+    }
+
+    return crc;
+}
+
+uint16_t OneWire::crc16(const uint8_t *input, uint16_t len, uint16_t crc)
+{
+    static const uint8_t oddparity[16] = { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        uint16_t cdata = input[i];
+        cdata = (cdata ^ crc) & 0xff;
+        crc >>= 8;
+
+        if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
+        {
+            crc ^= 0xC001;
+        }
+
+        cdata <<= 6;
+        crc ^= cdata;
+        cdata <<= 1;
+        crc ^= cdata;
+    }
+
+    return crc;
+}
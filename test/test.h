@@ -0,0 +1,26 @@
+/*
+
+Minimal assertions for the host tests, every test is a program which returns
+non-zero if any check failed.
+
+*/
+#ifndef test_h
+#define test_h
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (printf("%s: %s\n", __FILE__, testFailures == 0 ? "OK" : "FAILED"), testFailures != 0)
+
+#endif
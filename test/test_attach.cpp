@@ -0,0 +1,123 @@
+/*
+
+SoilSensor::begin(rom) after a reboot, on the same object and on a shared bus.
+A swapped sensor is reported against the stored ROM, calibration is loaded
+once per sensor and a sensor owned by another SoilSensor is never adopted.
+Calibration handed back after a reboot is not read again, a load failed on the
+bus is retried by the next begin.
+A probe hot-plugged in place of a quarantined one starts healthy.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+
+static uint32_t timed(SoilSensor *sensor, const uint8_t *rom, bool *found)
+{
+    uint32_t start = testMicros;
+
+    *found = rom != NULL ? sensor->begin(rom) : sensor->begin();
+
+    return testMicros - start;
+}
+
+int main()
+{
+    SimulatedBus bus;
+    bool found;
+    uint8_t romA[8];
+    uint8_t rom[8];
+
+    memcpy(romA, bus.add(1, 2000, 320)->rom, sizeof(romA));
+
+    SoilSensor first(&bus);
+    uint32_t search = timed(&first, NULL, &found);
+    TEST_CHECK(found);
+
+    // Reboot, same sensor
+    SoilSensor rebooted(&bus);
+    uint32_t reads = bus.eepromReads;
+    uint32_t cold = timed(&rebooted, romA, &found);
+    TEST_CHECK(found && !rebooted.isSwapped());
+    TEST_CHECK(bus.eepromReads > reads);
+
+    // Same object again, calibration is kept
+    reads = bus.eepromReads;
+    uint32_t warm = timed(&rebooted, romA, &found);
+    TEST_CHECK(found && !rebooted.isSwapped());
+    TEST_CHECK(bus.eepromReads == reads);
+
+    // Reboot with the calibration saved next to the ROM
+    soilSensorEeprom calibration;
+    soilSensorEeprom restoredCalibration;
+    rebooted.getCalibration(&calibration);
+    SoilSensor restored(&bus);
+    reads = bus.eepromReads;
+    uint32_t saved = testMicros;
+    found = restored.begin(romA, &calibration);
+    saved = testMicros - saved;
+    TEST_CHECK(found && !restored.isSwapped());
+    TEST_CHECK(bus.eepromReads == reads);
+    restored.getCalibration(&restoredCalibration);
+    TEST_CHECK(memcmp(&calibration, &restoredCalibration, sizeof(calibration)) == 0);
+
+    // Bus error during the load, the default calibration is not pinned
+    bus.sensors[0].status = DS28E17_STATUS_CRC;
+    SoilSensor disturbed(&bus);
+    TEST_CHECK(disturbed.begin(romA));
+    bus.sensors[0].status = 0;
+    reads = bus.eepromReads;
+    TEST_CHECK(disturbed.begin(romA));
+    TEST_CHECK(bus.eepromReads > reads);
+
+    // Reboot with the sensor replaced
+    bus.sensors[0].present = false;
+    bus.add(2, 2100, 320);
+    SoilSensor replaced(&bus);
+    TEST_CHECK(replaced.begin(romA));
+    TEST_CHECK(replaced.isSwapped());
+    replaced.getAddress(rom);
+    TEST_CHECK(rom[1] == 2);
+
+    // Shared bus with the stored sensor missing, neither of the others is adopted
+    bus.add(3, 2200, 320);
+    SoilSensor shared(&bus);
+    uint32_t missing = timed(&shared, romA, &found);
+    TEST_CHECK(!found);
+
+    // Stored sensor missed the first select, the search finds it among the others
+    bus.sensors[0].present = true;
+    bus.sensors[0].missedSelects = 1;
+    SoilSensor waking(&bus);
+    TEST_CHECK(waking.begin(romA));
+    TEST_CHECK(!waking.isSwapped());
+    waking.getAddress(rom);
+    TEST_CHECK(memcmp(rom, romA, sizeof(rom)) == 0);
+
+    // Dead probe is quarantined, its replacement on the same object is not
+    SimulatedBus hotPlug;
+    SoilSensor probe(&hotPlug);
+    uint16_t moisture;
+
+    hotPlug.add(1, 2000, 320);
+    TEST_CHECK(probe.begin());
+    probe.getAddress(rom);
+    hotPlug.sensors[0].present = false;
+
+    for (int i = 0; i < SOIL_SENSOR_QUARANTINE_FAILURES; i++)
+    {
+        TEST_CHECK(!probe.readMoistureRaw(&moisture));
+    }
+
+    TEST_CHECK(probe.isQuarantined());
+
+    hotPlug.add(2, 2100, 320);
+    TEST_CHECK(probe.begin(rom) && probe.isSwapped());
+    TEST_CHECK(!probe.isQuarantined());
+    TEST_CHECK(probe.health() == SOIL_SENSOR_HEALTH_MAX);
+    TEST_CHECK(probe.readMoistureRaw(&moisture) && (moisture == 2100));
+
+    printf("begin() %lu us, begin(rom) after reboot %lu us, with saved calibration %lu us, again %lu us, missing on shared bus %lu us\n",
+           (unsigned long) search, (unsigned long) cold, (unsigned long) saved, (unsigned long) warm, (unsigned long) missing);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+/*
+
+Batch arrays keep errors per field: a failed channel is stored as 0 instead of
+the previous reading, and a failed temperature does not void the moisture read
+in the same cycle. Checked for the non-blocking measurement, the blocking read
+of one sensor and the read of a group. A slot out of the arrays is refused.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+#include "SoilSensorGroup.h"
+
+#define SENSORS 2
+
+static uint16_t raw[SENSORS];
+static uint8_t moisture[SENSORS];
+static int16_t temperature[SENSORS];
+static uint8_t status[SENSORS];
+
+static soilSensorBatch batch = { SENSORS, raw, moisture, temperature, status, NULL };
+
+static void measure(SoilSensor *sensor, SimulatedBus *bus, uint32_t failSelect)
+{
+    uint32_t selects = bus->selects;
+
+    sensor->startMeasurement();
+
+    while (!sensor->process())
+    {
+        // Bridge misses the given step of the measurement
+        if (bus->selects - selects == failSelect - 1)
+        {
+            bus->sensors[0].missedSelects = 1;
+        }
+
+        delayMicroseconds(100);
+    }
+}
+
+static void testMeasurement()
+{
+    SimulatedBus bus;
+    SoilSensor sensor(&bus);
+
+    bus.add(1, 3000, 320);
+
+    TEST_CHECK(sensor.begin());
+
+    measure(&sensor, &bus, 0);
+
+    TEST_CHECK(sensor.getMeasurement(&batch, 0));
+    TEST_CHECK((raw[0] == 3000) && (temperature[0] == 320) && (moisture[0] > 0));
+
+    // Temperature read after a good moisture read fails
+    measure(&sensor, &bus, 4);
+
+    TEST_CHECK(!sensor.getMeasurement(&batch, 0));
+    TEST_CHECK(status[0] == SOIL_SENSOR_ERROR_TIMEOUT);
+    TEST_CHECK((raw[0] == 3000) && (moisture[0] > 0));
+    TEST_CHECK(temperature[0] == 0);
+
+    // Moisture fails, nothing of the previous cycle is left
+    bus.sensors[0].moisture = 0x4000;
+    measure(&sensor, &bus, 0);
+
+    TEST_CHECK(!sensor.getMeasurement(&batch, 0));
+    TEST_CHECK(status[0] == SOIL_SENSOR_ERROR_STALE);
+    TEST_CHECK((raw[0] == 0) && (moisture[0] == 0) && (temperature[0] == 0));
+}
+
+static void testReadBatch()
+{
+    SimulatedBus bus;
+    SoilSensor sensor(&bus);
+
+    bus.add(1, 3000, 320);
+
+    TEST_CHECK(sensor.begin());
+
+    // ZSSC3123 fails, TMP112 is still read
+    bus.sensors[0].moisture = 0x8000;
+
+    TEST_CHECK(!sensor.readBatch(&batch, 1));
+    TEST_CHECK(status[1] == SOIL_SENSOR_ERROR_DIAGNOSTIC);
+    TEST_CHECK((raw[1] == 0) && (moisture[1] == 0));
+    TEST_CHECK(temperature[1] == 320);
+}
+
+static void testSlot()
+{
+    SimulatedBus bus;
+    SoilSensor sensor(&bus);
+    uint16_t guard[SENSORS + 1];
+    soilSensorBatch small = { SENSORS, guard, NULL, NULL, NULL, NULL };
+
+    bus.add(1, 3000, 320);
+
+    TEST_CHECK(sensor.begin());
+
+    guard[SENSORS] = 0x5555;
+
+    TEST_CHECK(!sensor.readBatch(&small, SENSORS));
+
+    measure(&sensor, &bus, 0);
+
+    TEST_CHECK(!sensor.getMeasurement(&small, SENSORS));
+    TEST_CHECK(guard[SENSORS] == 0x5555);
+    TEST_CHECK(sensor.getMeasurement(&small, SENSORS - 1));
+}
+
+static void testGroup()
+{
+    SimulatedBus bus;
+    SoilSensor first(&bus);
+    SoilSensor second(&bus);
+    SoilSensorGroup group;
+
+    bus.add(1, 3000, 320);
+    bus.add(2, 3100, 336);
+
+    uint8_t rom[8];
+
+    memcpy(rom, bus.sensors[0].rom, 8);
+    TEST_CHECK(first.begin(rom));
+    memcpy(rom, bus.sensors[1].rom, 8);
+    TEST_CHECK(second.begin(rom));
+    TEST_CHECK(group.add(&first) && group.add(&second));
+
+    TEST_CHECK(group.readBatch(&batch));
+
+    // Second TMP112 read after the broadcast trigger is missed
+    bus.sensors[1].missedSelects = 1;
+
+    TEST_CHECK(!group.readBatch(&batch));
+    TEST_CHECK(status[0] == SOIL_SENSOR_ERROR_NONE);
+    TEST_CHECK(status[1] == SOIL_SENSOR_ERROR_TIMEOUT);
+    TEST_CHECK((raw[1] == 3100) && (moisture[1] > 0));
+    TEST_CHECK(temperature[1] == 0);
+}
+
+int main()
+{
+    testMeasurement();
+    testReadBatch();
+    testSlot();
+    testGroup();
+
+    return TEST_RESULT();
+}
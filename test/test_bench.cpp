@@ -0,0 +1,112 @@
+/*
+
+Benchmark of the batch API against the per-call API with 240 simulated sensors
+on 15 buses. The per-call application reads raw moisture, moisture in percent
+and temperature through out-pointers and copies them into its own arrays, the
+batch application lets SoilSensorGroup fill the arrays. Both have to give the
+same readings, bus time and host CPU time of both are printed.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+#include "SoilSensorGroup.h"
+#include <time.h>
+
+#define BUSES 15
+#define PER_BUS 16
+#define SENSORS (BUSES * PER_BUS)
+
+static SimulatedBus buses[BUSES];
+static SoilSensor *sensors[SENSORS];
+static SoilSensorGroup groups[BUSES];
+
+static uint16_t raw[2][SENSORS];
+static uint8_t moisture[2][SENSORS];
+static int16_t temperature[2][SENSORS];
+static uint8_t status[SENSORS];
+
+static void setup()
+{
+    for (uint16_t i = 0; i < SENSORS; i++)
+    {
+        SimulatedBus *bus = &buses[i / PER_BUS];
+        simulatedSensor *simulated = bus->add(i % PER_BUS + 1, 2000 + 7 * i, 200 + i);
+
+        // I2C transfer of a few bytes
+        simulated->busyTime = 500;
+
+        sensors[i] = new SoilSensor(bus);
+
+        TEST_CHECK(sensors[i]->begin(simulated->rom));
+        TEST_CHECK(groups[i / PER_BUS].add(sensors[i]));
+    }
+}
+
+static void perCall(unsigned long *busTime, double *cpuTime)
+{
+    unsigned long start = testMicros;
+    clock_t cpu = clock();
+
+    for (uint16_t i = 0; i < SENSORS; i++)
+    {
+        uint16_t value;
+        uint8_t percent;
+        int16_t fixed;
+
+        TEST_CHECK(sensors[i]->readMoistureRaw(&value));
+        raw[0][i] = value;
+
+        TEST_CHECK(sensors[i]->readMoisture(&percent));
+        moisture[0][i] = percent;
+
+        TEST_CHECK(sensors[i]->readTemperatureRaw(&fixed));
+        temperature[0][i] = fixed;
+    }
+
+    *cpuTime = (double) (clock() - cpu) / CLOCKS_PER_SEC;
+    *busTime = testMicros - start;
+}
+
+static void batch(unsigned long *busTime, double *cpuTime)
+{
+    unsigned long start = testMicros;
+    clock_t cpu = clock();
+
+    for (uint8_t i = 0; i < BUSES; i++)
+    {
+        soilSensorBatch arrays = { PER_BUS, &raw[1][i * PER_BUS], &moisture[1][i * PER_BUS], &temperature[1][i * PER_BUS], &status[i * PER_BUS], NULL };
+
+        TEST_CHECK(groups[i].readBatch(&arrays));
+    }
+
+    *cpuTime = (double) (clock() - cpu) / CLOCKS_PER_SEC;
+    *busTime = testMicros - start;
+}
+
+int main()
+{
+    unsigned long perCallBus, batchBus;
+    double perCallCpu, batchCpu;
+
+    setup();
+
+    perCall(&perCallBus, &perCallCpu);
+    batch(&batchBus, &batchCpu);
+
+    printf("%d sensors on %d buses\n", SENSORS, BUSES);
+    printf("per-call  bus %8lu us  host cpu %6.0f us\n", perCallBus, perCallCpu * 1e6);
+    printf("batch     bus %8lu us  host cpu %6.0f us\n", batchBus, batchCpu * 1e6);
+
+    TEST_CHECK(memcmp(raw[0], raw[1], sizeof(raw[0])) == 0);
+    TEST_CHECK(memcmp(moisture[0], moisture[1], sizeof(moisture[0])) == 0);
+    TEST_CHECK(memcmp(temperature[0], temperature[1], sizeof(temperature[0])) == 0);
+
+    for (uint16_t i = 0; i < SENSORS; i++)
+    {
+        TEST_CHECK(status[i] == SOIL_SENSOR_ERROR_NONE);
+    }
+
+    TEST_CHECK(batchBus < perCallBus);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,118 @@
+/*
+
+Binary export of batch arrays: little endian on the wire, absent arrays are
+skipped and a decoder of the format gets the arrays back. Built twice, writing
+the arrays in place and encoding them through the buffer of big endian CPUs.
+
+*/
+#include "test.h"
+#include "SoilSensorExport.h"
+
+#define SLOTS 20
+
+class Capture : public Print
+{
+  public:
+    uint8_t data[512];
+    size_t length;
+
+    Capture()
+    {
+        length = 0;
+    }
+
+    size_t write(uint8_t value)
+    {
+        data[length++] = value;
+
+        return 1;
+    }
+
+    using Print::write;
+};
+
+static uint32_t decode(const uint8_t **p, uint8_t size)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < size; i++)
+    {
+        value |= (uint32_t) *(*p)++ << (8 * i);
+    }
+
+    return value;
+}
+
+int main()
+{
+    uint16_t raw[SLOTS];
+    uint8_t moisture[SLOTS];
+    int16_t temperature[SLOTS];
+    uint8_t status[SLOTS];
+    uint32_t timestamp[SLOTS];
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        raw[i] = 0x1234 + 257 * i;
+        moisture[i] = i * 5;
+        temperature[i] = -40 + 37 * i;
+        status[i] = i % 3;
+        timestamp[i] = 0x89ABCDEFUL + 1000 * i;
+    }
+
+    soilSensorBatch batch = { SLOTS, raw, moisture, temperature, status, timestamp };
+    Capture out;
+
+    size_t written = SoilSensorExport::write(&batch, SLOTS, out);
+
+    TEST_CHECK(written == out.length);
+    TEST_CHECK(written == 3 + SLOTS * (2 + 1 + 2 + 1 + 4));
+
+    // Count, present arrays, then the first raw value low byte first
+    const uint8_t start[5] = { SLOTS, 0, 0x1F, 0x34, 0x12 };
+
+    TEST_CHECK(memcmp(out.data, start, sizeof(start)) == 0);
+
+    const uint8_t *p = out.data + 3;
+    bool same = true;
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        same = same && (decode(&p, 2) == raw[i]);
+    }
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        same = same && (decode(&p, 1) == moisture[i]);
+    }
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        same = same && ((int16_t) decode(&p, 2) == temperature[i]);
+    }
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        same = same && (decode(&p, 1) == status[i]);
+    }
+
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        same = same && (decode(&p, 4) == timestamp[i]);
+    }
+
+    TEST_CHECK(same);
+    TEST_CHECK(p == out.data + out.length);
+
+    // Absent arrays are neither written nor flagged
+    soilSensorBatch partial = { SLOTS, NULL, NULL, temperature, NULL, NULL };
+    Capture partialOut;
+
+    TEST_CHECK(SoilSensorExport::write(&partial, SLOTS, partialOut) == 3 + SLOTS * 2);
+    TEST_CHECK(partialOut.data[2] == SOIL_SENSOR_EXPORT_TEMPERATURE);
+    TEST_CHECK(memcmp(partialOut.data + 3, out.data + 3 + SLOTS * 3, SLOTS * 2) == 0);
+
+    printf("%s, %d slots in %lu bytes\n", SOIL_SENSOR_EXPORT_IN_PLACE ? "in place" : "encoded", SLOTS, (unsigned long) written);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,247 @@
+/*
+
+Broadcast paths of SoilSensorGroup on one simulated bus with eight sensors. A
+wake, temperature and sleep cycle of the group takes one reset for the wake
+up, Skip ROM for the TMP112 trigger and for the sleep and one select for every
+read, every sensor converts once and sleeps after it. The cycle is compared
+with the same cycle sensor by sensor, which leaves only the last sensor asleep
+as every wake up resets the whole bus. A quarantined sensor is left out of the
+reads, after the quarantine it gets its own trigger until it reads again. A
+group of one sensor does not broadcast.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+#include "SoilSensorGroup.h"
+
+#define SENSORS 8
+
+typedef struct
+{
+    uint32_t time;
+    uint32_t resets;
+    uint32_t selects;
+    uint32_t skips;
+} traffic;
+
+static SimulatedBus bus;
+static SoilSensor *sensors[SENSORS];
+static SoilSensorGroup group;
+static int16_t temperatures[SENSORS];
+
+static traffic snapshot()
+{
+    traffic now = { (uint32_t) testMicros, bus.resets, bus.selects, bus.skips };
+
+    return now;
+}
+
+static traffic since(traffic start)
+{
+    traffic now = snapshot();
+    traffic used = { now.time - start.time, now.resets - start.resets, now.selects - start.selects, now.skips - start.skips };
+
+    return used;
+}
+
+static void print(const char *name, traffic used)
+{
+    printf("%-10s %6lu us  resets %2lu  selects %2lu  skips %lu\n", name, (unsigned long) used.time,
+           (unsigned long) used.resets, (unsigned long) used.selects, (unsigned long) used.skips);
+}
+
+static bool allAsleep(bool asleep)
+{
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        if (bus.sensors[i].asleep != asleep)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool checkTemperatures(uint8_t skipped)
+{
+    bool same = true;
+
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        same = same && ((i == skipped) || (temperatures[i] == 320 + i));
+    }
+
+    return same;
+}
+
+static void setup()
+{
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        simulatedSensor *simulated = bus.add(i + 1, 2000 + i, 320 + i);
+
+        simulated->busyTime = 500;
+        sensors[i] = new SoilSensor(&bus);
+
+        TEST_CHECK(sensors[i]->begin(simulated->rom));
+        TEST_CHECK(group.add(sensors[i]));
+    }
+}
+
+static void testBroadcast()
+{
+    uint32_t conversions[SENSORS];
+
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        conversions[i] = bus.sensors[i].conversions;
+    }
+
+    traffic start = snapshot();
+
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        sensors[i]->wakeUp();
+        TEST_CHECK(sensors[i]->readTemperatureRaw(&temperatures[i]));
+        sensors[i]->sleep();
+    }
+
+    traffic single = since(start);
+
+    TEST_CHECK(checkTemperatures(SENSORS));
+
+    // Reset of every wake up woke the sensors put to sleep before
+    TEST_CHECK(bus.sensors[SENSORS - 1].asleep && !bus.sensors[0].asleep);
+
+    memset(temperatures, 0, sizeof(temperatures));
+    start = snapshot();
+
+    group.wakeUp();
+
+    TEST_CHECK(allAsleep(false));
+    TEST_CHECK(group.readTemperatureRaw(temperatures));
+
+    group.sleep();
+
+    traffic broadcast = since(start);
+
+    print("per sensor", single);
+    print("group", broadcast);
+
+    TEST_CHECK(checkTemperatures(SENSORS));
+    TEST_CHECK(allAsleep(true));
+
+    // Wake up, trigger, one read per sensor and sleep
+    TEST_CHECK(single.resets == 4 * SENSORS);
+    TEST_CHECK(single.selects == 3 * SENSORS);
+    TEST_CHECK(single.skips == 0);
+    TEST_CHECK(broadcast.resets == 3 + SENSORS);
+    TEST_CHECK(broadcast.selects == SENSORS);
+    TEST_CHECK(broadcast.skips == 2);
+    TEST_CHECK(broadcast.time * 2 < single.time);
+
+    // Every TMP112 converted once in each cycle
+    for (uint8_t i = 0; i < SENSORS; i++)
+    {
+        TEST_CHECK(bus.sensors[i].conversions == conversions[i] + 2);
+    }
+}
+
+static void testQuarantined()
+{
+    const uint8_t failing = 3;
+    uint16_t moisture;
+
+    group.wakeUp();
+
+    // Bridge of one sensor fails until it is quarantined
+    bus.sensors[failing].status = DS28E17_STATUS_ADDRESS_NACK;
+
+    while (!sensors[failing]->isQuarantined())
+    {
+        TEST_CHECK(!sensors[failing]->readMoistureRaw(&moisture));
+    }
+
+    bus.sensors[failing].status = 0;
+
+    uint32_t conversions = bus.sensors[failing].conversions;
+    traffic start = snapshot();
+
+    // Quarantined sensor is not read at all
+    TEST_CHECK(!group.readTemperatureRaw(temperatures));
+
+    traffic used = since(start);
+
+    print("quarantine", used);
+
+    TEST_CHECK(sensors[failing]->lastError() == SOIL_SENSOR_ERROR_QUARANTINED);
+    TEST_CHECK(checkTemperatures(failing));
+    TEST_CHECK(used.skips == 1);
+    TEST_CHECK(used.selects == SENSORS - 1);
+
+    // After the quarantine the sensor failed last time, so it gets its own trigger besides the broadcast
+    delay(SOIL_SENSOR_QUARANTINE_BASE);
+
+    TEST_CHECK(!sensors[failing]->isQuarantined());
+
+    start = snapshot();
+
+    TEST_CHECK(group.readTemperatureRaw(temperatures));
+
+    used = since(start);
+
+    print("fallback", used);
+
+    TEST_CHECK(checkTemperatures(SENSORS));
+    TEST_CHECK(used.skips == 1);
+    TEST_CHECK(used.selects == SENSORS + 1);
+    TEST_CHECK(bus.sensors[failing].conversions == conversions + 3);
+
+    // Read again, it is back on the broadcast
+    start = snapshot();
+
+    TEST_CHECK(group.readTemperatureRaw(temperatures));
+
+    used = since(start);
+
+    TEST_CHECK(used.skips == 1);
+    TEST_CHECK(used.selects == SENSORS);
+
+    group.sleep();
+}
+
+static void testSingle()
+{
+    SimulatedBus single;
+    SoilSensor sensor(&single);
+    SoilSensorGroup alone;
+    int16_t temperature;
+
+    single.add(1, 2000, 320)->busyTime = 500;
+
+    TEST_CHECK(sensor.begin());
+    TEST_CHECK(alone.add(&sensor));
+
+    alone.wakeUp();
+
+    TEST_CHECK(alone.readTemperatureRaw(&temperature));
+
+    alone.sleep();
+
+    TEST_CHECK(temperature == 320);
+    TEST_CHECK(single.skips == 0);
+    TEST_CHECK(single.sensors[0].asleep);
+    TEST_CHECK(single.sensors[0].conversions == 1);
+}
+
+int main()
+{
+    setup();
+
+    testBroadcast();
+    testQuarantined();
+    testSingle();
+
+    return TEST_RESULT();
+}
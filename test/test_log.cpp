@@ -0,0 +1,182 @@
+/*
+
+SoilSensorLog encoding: lossless round trip, eviction of the oldest block,
+portable little endian header, paging of every sample once including the
+flushed newest block, bytes per sample and encode cost on a synthetic day
+sampled every minute.
+
+*/
+#include "test.h"
+#include "SoilSensorLog.h"
+#include <time.h>
+
+#define SAMPLES 1440
+
+static soilSensorLogSample trace[SAMPLES];
+
+static uint8_t paged[64][SOIL_SENSOR_LOG_BLOCK_SIZE];
+static uint16_t pagedCount = 0;
+
+static void pager(const uint8_t *block, size_t size)
+{
+    TEST_CHECK(size == SOIL_SENSOR_LOG_BLOCK_SIZE);
+
+    memcpy(paged[pagedCount++], block, size);
+}
+
+static void makeTrace()
+{
+    uint16_t moisture = 2600;
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        // Drying with noise of the converter, one irrigation
+        moisture += (i * 7 % 5) - 2 - (i % 15 == 0 ? 1 : 0);
+        moisture += i == 600 ? 300 : 0;
+
+        trace[i].time = 1700000000UL + i * 60;
+        trace[i].moisture = moisture;
+        trace[i].temperature = (int16_t) (16 * (2 + 3 * sin(2 * M_PI * i / SAMPLES)));
+    }
+}
+
+static bool same(const soilSensorLogSample *a, const soilSensorLogSample *b)
+{
+    return (a->time == b->time) && (a->moisture == b->moisture) && (a->temperature == b->temperature);
+}
+
+static void testRoundTrip()
+{
+    static uint8_t buffer[128 * SOIL_SENSOR_LOG_BLOCK_SIZE];
+    SoilSensorLog log(buffer, sizeof(buffer));
+
+    clock_t start = clock();
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        log.push(trace[i].time, trace[i].moisture, trace[i].temperature);
+    }
+
+    double cost = (double) (clock() - start) / CLOCKS_PER_SEC / SAMPLES * 1e9;
+
+    TEST_CHECK(log.count() == SAMPLES);
+
+    soilSensorLogCursor cursor;
+    soilSensorLogSample sample;
+    int decoded = 0;
+
+    log.rewind(&cursor);
+
+    while (log.read(&cursor, &sample))
+    {
+        TEST_CHECK(same(&sample, &trace[decoded]));
+        decoded++;
+    }
+
+    TEST_CHECK(decoded == SAMPLES);
+
+    printf("%d samples in %lu bytes, %.2f bytes per sample, raw %u, encode %.0f ns per sample\n",
+           SAMPLES, (unsigned long) log.length(), (double) log.length() / SAMPLES,
+           (unsigned) sizeof(soilSensorLogSample), cost);
+
+    TEST_CHECK(log.length() * 2 < SAMPLES * sizeof(soilSensorLogSample));
+}
+
+static void testEviction()
+{
+    static uint8_t buffer[4 * SOIL_SENSOR_LOG_BLOCK_SIZE];
+    SoilSensorLog log(buffer, sizeof(buffer));
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        log.push(trace[i].time, trace[i].moisture, trace[i].temperature);
+    }
+
+    soilSensorLogCursor cursor;
+    soilSensorLogSample sample;
+    int first = SAMPLES - log.count();
+    int decoded = 0;
+
+    log.rewind(&cursor);
+
+    // Only the newest samples are kept, without a gap
+    while (log.read(&cursor, &sample))
+    {
+        TEST_CHECK(same(&sample, &trace[first + decoded]));
+        decoded++;
+    }
+
+    TEST_CHECK(decoded == log.count());
+    TEST_CHECK(first > 0);
+}
+
+static void testHeader()
+{
+    static uint8_t buffer[SOIL_SENSOR_LOG_BLOCK_SIZE];
+    SoilSensorLog log(buffer, sizeof(buffer));
+
+    log.push(0x12345678, 0x9abc, -2);
+    log.push(0x12345679, 0x9abc, -2);
+
+    const uint8_t header[SOIL_SENSOR_LOG_HEADER_SIZE] = { 0x78, 0x56, 0x34, 0x12, 0xbc, 0x9a, 0xfe, 0xff, 2, 3 };
+
+    TEST_CHECK(memcmp(buffer, header, sizeof(header)) == 0);
+    TEST_CHECK(log.length() == SOIL_SENSOR_LOG_HEADER_SIZE + 3);
+}
+
+static void testPaging()
+{
+    static uint8_t buffer[2 * SOIL_SENSOR_LOG_BLOCK_SIZE];
+    SoilSensorLog log(buffer, sizeof(buffer));
+
+    TEST_CHECK(!log.flush());
+
+    log.setPager(pager);
+
+    TEST_CHECK(!log.flush());
+
+    for (int i = 0; i < 200; i++)
+    {
+        log.push(trace[i].time, trace[i].moisture, trace[i].temperature);
+
+        // Power down in the middle of the trace
+        if (i == 100)
+        {
+            TEST_CHECK(log.flush());
+            TEST_CHECK(!log.flush());
+        }
+    }
+
+    TEST_CHECK(log.flush());
+
+    // Every sample is paged exactly once and decodes from the page alone
+    int decoded = 0;
+
+    for (uint16_t i = 0; i < pagedCount; i++)
+    {
+        soilSensorLogCursor cursor;
+        soilSensorLogSample sample;
+
+        memset(&cursor, 0, sizeof(cursor));
+
+        while (SoilSensorLog::readBlock(paged[i], &cursor, &sample))
+        {
+            TEST_CHECK(same(&sample, &trace[decoded]));
+            decoded++;
+        }
+    }
+
+    TEST_CHECK(decoded == 200);
+}
+
+int main()
+{
+    makeTrace();
+
+    testRoundTrip();
+    testEviction();
+    testHeader();
+    testPaging();
+
+    return TEST_RESULT();
+}
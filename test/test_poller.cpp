@@ -0,0 +1,153 @@
+/*
+
+SoilSensorPoller over simulated buses, one sensor on each. Every slot has to
+get its own reading and a missing sensor must not hold the others back. The
+speedup of interleaving over reading the buses one after another is reported
+against the number of buses at I2C transfer times of a few hundred
+microseconds, as the bridges of the soil sensor take. Bit-banged buses keep
+the CPU for every slot, so interleaving hides only the I2C transfers and must
+not be slower. UART buses send the slots in the background and have to scale
+with the number of buses.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+#include "LoopbackUart.h"
+#include "OneWireUart.h"
+#include "SoilSensorPoller.h"
+
+#define BUSES 4
+
+static const uint32_t busyTimes[] = { 300, 500 };
+static const uint8_t busCounts[] = { 1, 2, 4 };
+
+static float speedup(uint8_t count, uint32_t busyTime, bool uart)
+{
+    SimulatedBus buses[BUSES];
+    LoopbackUart uarts[BUSES];
+    OneWireUartBus *uartBuses[BUSES];
+    SoilSensor *sensors[BUSES];
+    SoilSensorPoller poller;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        simulatedSensor *simulated = buses[i].add(i + 1, 2000 + i, 320 + i);
+
+        simulated->busyTime = busyTime;
+
+        if (uart)
+        {
+            uarts[i].addBridge(&buses[i], simulated);
+            uartBuses[i] = new OneWireUartBus(&uarts[i]);
+            uartBuses[i]->begin();
+            sensors[i] = new SoilSensor(uartBuses[i]);
+        }
+        else
+        {
+            sensors[i] = new SoilSensor(&buses[i]);
+        }
+
+        TEST_CHECK(sensors[i]->begin(simulated->rom));
+        TEST_CHECK(poller.add(sensors[i]));
+    }
+
+    uint32_t start = testMicros;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint16_t moisture;
+        int16_t temperature;
+
+        TEST_CHECK(sensors[i]->readMoistureRaw(&moisture) && sensors[i]->readTemperatureRaw(&temperature));
+    }
+
+    uint32_t sequential = testMicros - start;
+
+    uint16_t raw[BUSES];
+    int16_t temperature[BUSES];
+    uint8_t status[BUSES];
+    soilSensorBatch batch = { count, raw, NULL, temperature, status, NULL };
+
+    start = testMicros;
+
+    TEST_CHECK(poller.readBatch(&batch));
+
+    uint32_t interleaved = testMicros - start;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        TEST_CHECK(status[i] == SOIL_SENSOR_ERROR_NONE);
+        TEST_CHECK(raw[i] == 2000 + i);
+        TEST_CHECK(temperature[i] == 320 + i);
+        delete sensors[i];
+
+        if (uart)
+        {
+            delete uartBuses[i];
+        }
+    }
+
+    printf("%-4s busy %3lu us  %d buses  sequential %6lu us  interleaved %6lu us  speedup %.2f\n", uart ? "uart" : "pin",
+           (unsigned long) busyTime, count, (unsigned long) sequential, (unsigned long) interleaved, (float) sequential / interleaved);
+
+    return (float) sequential / interleaved;
+}
+
+static void testScaling()
+{
+    for (uint8_t i = 0; i < sizeof(busyTimes) / sizeof(busyTimes[0]); i++)
+    {
+        float previous = 0;
+
+        for (uint8_t j = 0; j < sizeof(busCounts) / sizeof(busCounts[0]); j++)
+        {
+            TEST_CHECK(speedup(busCounts[j], busyTimes[i], false) >= 1);
+        }
+
+        for (uint8_t j = 0; j < sizeof(busCounts) / sizeof(busCounts[0]); j++)
+        {
+            float s = speedup(busCounts[j], busyTimes[i], true);
+
+            // At least half of the ideal speedup of one measurement per bus at a time
+            TEST_CHECK(s > previous);
+            TEST_CHECK(s * 2 > busCounts[j]);
+            previous = s;
+        }
+    }
+}
+
+static void testMissing()
+{
+    SimulatedBus buses[BUSES];
+    SoilSensor *sensors[BUSES];
+    SoilSensorPoller poller;
+
+    for (uint8_t i = 0; i < BUSES; i++)
+    {
+        buses[i].add(i + 1, 2000 + i, 320 + i)->busyTime = 500;
+        sensors[i] = new SoilSensor(&buses[i]);
+
+        TEST_CHECK(sensors[i]->begin());
+        TEST_CHECK(poller.add(sensors[i]));
+    }
+
+    uint16_t raw[BUSES];
+    int16_t temperature[BUSES];
+    uint8_t status[BUSES];
+    soilSensorBatch batch = { BUSES, raw, NULL, temperature, status, NULL };
+
+    buses[1].sensors[0].present = false;
+
+    TEST_CHECK(!poller.readBatch(&batch));
+    TEST_CHECK(status[1] == SOIL_SENSOR_ERROR_PRESENCE);
+    TEST_CHECK(status[0] == SOIL_SENSOR_ERROR_NONE);
+    TEST_CHECK(raw[3] == 2003);
+}
+
+int main()
+{
+    testScaling();
+    testMissing();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/*
+
+Error classification, health and quarantine of one sensor. Every fault of the
+bridge, the I2C devices and the ZSSC3123 data gives its own lastError(), the
+channels lose and regain health apart, repeated failures quarantine the sensor
+without touching the bus and the back-off doubles on every failed probe up to
+SOIL_SENSOR_QUARANTINE_MAX. A good probe lifts the quarantine.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+
+typedef struct
+{
+    const char *name;
+    bool present;
+    uint16_t moisture;
+    uint32_t busyTime;
+    uint8_t status;
+    soilSensorError expected;
+} fault;
+
+static const fault faults[] =
+{
+    { "none",           true,  3000,   500, 0x00,                         SOIL_SENSOR_ERROR_NONE },
+    { "absent",         false, 3000,   500, 0x00,                         SOIL_SENSOR_ERROR_PRESENCE },
+    { "stuck busy",     true,  3000, 80000, 0x00,                         SOIL_SENSOR_ERROR_TIMEOUT },
+    { "crc",            true,  3000,   500, DS28E17_STATUS_CRC,           SOIL_SENSOR_ERROR_CRC },
+    { "address nack",   true,  3000,   500, DS28E17_STATUS_ADDRESS_NACK,  SOIL_SENSOR_ERROR_ADDRESS_NACK },
+    { "start",          true,  3000,   500, DS28E17_STATUS_START,         SOIL_SENSOR_ERROR_START },
+    { "reserved bit",   true,  3000,   500, 0x04,                         SOIL_SENSOR_ERROR_NONE },
+    { "crc and start",  true,  3000,   500, DS28E17_STATUS_CRC | DS28E17_STATUS_START, SOIL_SENSOR_ERROR_CRC },
+    { "stale",          true,  0x4000 | 3000, 500, 0x00,                  SOIL_SENSOR_ERROR_STALE },
+    { "diagnostic",     true,  0xc000 | 3000, 500, 0x00,                  SOIL_SENSOR_ERROR_DIAGNOSTIC },
+};
+
+static void testClassification()
+{
+    for (uint8_t i = 0; i < sizeof(faults) / sizeof(faults[0]); i++)
+    {
+        SimulatedBus bus;
+        SoilSensor sensor(&bus);
+        simulatedSensor *simulated = bus.add(1, 3000, 320);
+
+        simulated->busyTime = 500;
+
+        TEST_CHECK(sensor.begin(simulated->rom));
+
+        simulated->present = faults[i].present;
+        simulated->moisture = faults[i].moisture;
+        simulated->busyTime = faults[i].busyTime;
+        simulated->status = faults[i].status;
+
+        uint16_t moisture = 0;
+        bool success = sensor.readMoistureRaw(&moisture);
+
+        if (sensor.lastError() != faults[i].expected)
+        {
+            printf("%s: error %d, expected %d\n", faults[i].name, sensor.lastError(), faults[i].expected);
+        }
+
+        TEST_CHECK(success == (faults[i].expected == SOIL_SENSOR_ERROR_NONE));
+        TEST_CHECK(sensor.lastError() == faults[i].expected);
+        TEST_CHECK(sensor.health() == (success ? SOIL_SENSOR_HEALTH_MAX : SOIL_SENSOR_HEALTH_MAX - SOIL_SENSOR_HEALTH_LOSS));
+        TEST_CHECK(!sensor.isQuarantined());
+    }
+}
+
+static void testHealth()
+{
+    SimulatedBus bus;
+    SoilSensor sensor(&bus);
+    simulatedSensor *simulated = bus.add(1, 3000, 320);
+    uint16_t moisture;
+    int16_t temperature;
+
+    simulated->busyTime = 500;
+
+    TEST_CHECK(sensor.begin(simulated->rom));
+
+    // ZSSC3123 fails twice, good TMP112 reads do not hide it
+    simulated->moisture = 0x8000;
+
+    for (uint8_t i = 0; i < SOIL_SENSOR_QUARANTINE_FAILURES - 1; i++)
+    {
+        TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+        TEST_CHECK(sensor.readTemperatureRaw(&temperature));
+    }
+
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_MAX - (SOIL_SENSOR_QUARANTINE_FAILURES - 1) * SOIL_SENSOR_HEALTH_LOSS);
+    TEST_CHECK(!sensor.isQuarantined());
+
+    // Every good read regains a part of the health
+    simulated->moisture = 3000;
+
+    TEST_CHECK(sensor.readMoistureRaw(&moisture));
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_MAX - (SOIL_SENSOR_QUARANTINE_FAILURES - 1) * SOIL_SENSOR_HEALTH_LOSS + SOIL_SENSOR_HEALTH_GAIN);
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        TEST_CHECK(sensor.readMoistureRaw(&moisture));
+    }
+
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_MAX);
+
+    // A failed TMP112 lowers the health of the sensor as well, the count of failures starts again
+    simulated->status = DS28E17_STATUS_ADDRESS_NACK;
+
+    TEST_CHECK(!sensor.readTemperatureRaw(&temperature));
+    TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_ADDRESS_NACK);
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_MAX - SOIL_SENSOR_HEALTH_LOSS);
+    TEST_CHECK(!sensor.isQuarantined());
+}
+
+static uint32_t backOff(SoilSensor *sensor)
+{
+    uint32_t start = millis();
+
+    while (sensor->isQuarantined())
+    {
+        delay(1);
+    }
+
+    return millis() - start;
+}
+
+static void testBackOff()
+{
+    SimulatedBus bus;
+    SoilSensor sensor(&bus);
+    simulatedSensor *simulated = bus.add(1, 3000, 320);
+    uint16_t moisture;
+
+    simulated->busyTime = 500;
+
+    TEST_CHECK(sensor.begin(simulated->rom));
+
+    // The probe is unplugged
+    simulated->present = false;
+
+    for (uint8_t i = 0; i < SOIL_SENSOR_QUARANTINE_FAILURES; i++)
+    {
+        TEST_CHECK(!sensor.isQuarantined());
+        TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+        TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_PRESENCE);
+    }
+
+    TEST_CHECK(sensor.isQuarantined());
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_MAX - SOIL_SENSOR_QUARANTINE_FAILURES * SOIL_SENSOR_HEALTH_LOSS);
+
+    // Quarantined reads are refused without a reset of the bus
+    uint32_t resets = bus.resets;
+
+    TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+    TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_QUARANTINED);
+    TEST_CHECK(bus.resets == resets);
+
+    uint32_t expected = SOIL_SENSOR_QUARANTINE_BASE;
+    uint32_t time = backOff(&sensor);
+    uint8_t probes = 0;
+
+    TEST_CHECK(time == expected);
+
+    // Every failed probe doubles the back-off until the limit
+    while (expected < SOIL_SENSOR_QUARANTINE_MAX)
+    {
+        expected = expected * 2 > SOIL_SENSOR_QUARANTINE_MAX ? SOIL_SENSOR_QUARANTINE_MAX : expected * 2;
+
+        TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+        TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_PRESENCE);
+
+        time = backOff(&sensor);
+        probes++;
+
+        if (time != expected)
+        {
+            printf("probe %d: back-off %lu ms, expected %lu ms\n", probes, (unsigned long) time, (unsigned long) expected);
+        }
+
+        TEST_CHECK(time == expected);
+    }
+
+    TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+    TEST_CHECK(backOff(&sensor) == SOIL_SENSOR_QUARANTINE_MAX);
+    TEST_CHECK(sensor.health() == 0);
+
+    printf("back-off from %d ms to %lu ms in %d probes\n", SOIL_SENSOR_QUARANTINE_BASE, (unsigned long) expected, probes);
+
+    // The probe is plugged back, the first good read lifts the quarantine
+    simulated->present = true;
+
+    TEST_CHECK(sensor.readMoistureRaw(&moisture));
+    TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_NONE);
+    TEST_CHECK(!sensor.isQuarantined());
+    TEST_CHECK(sensor.health() == SOIL_SENSOR_HEALTH_GAIN);
+
+    // Next failures start from the base back-off again
+    simulated->status = DS28E17_STATUS_START;
+
+    for (uint8_t i = 0; i < SOIL_SENSOR_QUARANTINE_FAILURES; i++)
+    {
+        TEST_CHECK(!sensor.readMoistureRaw(&moisture));
+        TEST_CHECK(sensor.lastError() == SOIL_SENSOR_ERROR_START);
+    }
+
+    TEST_CHECK(backOff(&sensor) == SOIL_SENSOR_QUARANTINE_BASE);
+}
+
+int main()
+{
+    testClassification();
+    testHealth();
+    testBackOff();
+
+    return TEST_RESULT();
+}
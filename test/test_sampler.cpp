@@ -0,0 +1,233 @@
+/*
+
+Sampling policy of SoilSensorSampler fed by a synthetic day of readings:
+drying soil, two irrigations and a daily temperature swing sampled every
+second. Samples taken, error of the last reported reading against the trace
+and latency of the first report after an irrigation starts are compared with
+fixed-interval sampling at the shortest interval and at the interval giving
+the same number of samples. Results are averaged over irrigations shifted
+across the longest interval, so the phase of the schedule does not decide.
+
+*/
+#include "test.h"
+#include "SoilSensorSampler.h"
+
+#define DAY 86400UL
+
+#define PHASES 15
+
+static const uint32_t irrigation[2] = { 6 * 3600UL, 18 * 3600UL };
+static uint32_t rise;
+static uint32_t shift;
+
+static uint16_t traceMoisture(uint32_t second)
+{
+    // Slow drying by 100 counts a day, irrigation raises it by 300 in rise seconds then decays
+    float moisture = 2600 - 100.0 * second / DAY;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (second < irrigation[i] + shift)
+        {
+            continue;
+        }
+
+        uint32_t since = second - irrigation[i] - shift;
+
+        moisture += since < rise ? 300.0 * since / rise : 300.0 * exp(((float) rise - since) / 7200.0);
+    }
+
+    return (uint16_t) moisture;
+}
+
+static float traceTemperature(uint32_t second)
+{
+    return 18 + 3 * sin(2 * M_PI * second / DAY);
+}
+
+typedef struct
+{
+    uint32_t samples;
+    uint32_t reports;
+    uint16_t maxError;
+    float meanError;
+    uint32_t latency;           //! @brief Longest time from the start of an irrigation to its first report
+} fidelity;
+
+static fidelity run(SoilSensorSampler *sampler, uint32_t fixedInterval)
+{
+    fidelity result = { 0, 0, 0, 0, 0 };
+    uint32_t next = 0;
+    uint16_t reported = 0;
+    double errorSum = 0;
+    bool detected[2] = { false, false };
+
+    for (uint32_t second = 0; second < DAY; second++)
+    {
+        uint16_t moisture = traceMoisture(second);
+
+        if (second >= next)
+        {
+            result.samples++;
+
+            if (sampler->feed(moisture, traceTemperature(second), second * 1000))
+            {
+                result.reports++;
+                reported = moisture;
+
+                // Drying is reported downwards, so the first rise after the start is the irrigation
+                for (int i = 0; i < 2; i++)
+                {
+                    uint32_t start = irrigation[i] + shift;
+
+                    if (!detected[i] && (second >= start) && (moisture > traceMoisture(start - 1)))
+                    {
+                        detected[i] = true;
+
+                        if (second - start > result.latency)
+                        {
+                            result.latency = second - start;
+                        }
+                    }
+                }
+            }
+
+            next = second + (fixedInterval != 0 ? fixedInterval : sampler->interval() / 1000);
+        }
+
+        uint16_t error = moisture > reported ? moisture - reported : reported - moisture;
+
+        errorSum += error;
+
+        if (error > result.maxError)
+        {
+            result.maxError = error;
+        }
+    }
+
+    result.meanError = errorSum / DAY;
+
+    return result;
+}
+
+static void print(const char *name, fidelity result)
+{
+    printf("%-10s samples %6lu  reports %4lu  max error %3u  mean error %5.2f  latency %3lu s\n",
+           name, (unsigned long) result.samples, (unsigned long) result.reports, result.maxError, result.meanError,
+           (unsigned long) result.latency);
+}
+
+static void add(fidelity *sum, fidelity result)
+{
+    sum->samples += result.samples;
+    sum->reports += result.reports;
+    sum->meanError += result.meanError;
+
+    if (result.maxError > sum->maxError)
+    {
+        sum->maxError = result.maxError;
+    }
+
+    if (result.latency > sum->latency)
+    {
+        sum->latency = result.latency;
+    }
+}
+
+static fidelity average(fidelity sum)
+{
+    sum.samples /= PHASES;
+    sum.reports /= PHASES;
+    sum.meanError /= PHASES;
+
+    return sum;
+}
+
+static void testSlowDrift()
+{
+    SoilSensorSampler sampler(NULL);
+    uint32_t time = 0;
+
+    sampler.setInterval(2000, 600000);
+
+    sampler.feed(2000, 20, time);
+
+    while (sampler.interval() < 600000)
+    {
+        time += sampler.interval();
+        sampler.feed(2000, 20, time);
+    }
+
+    // 32 counts over 10 minutes is drying, not irrigation
+    time += 600000;
+    sampler.feed(2032, 20, time);
+
+    TEST_CHECK(sampler.interval() == 300000);
+
+    // 32 counts in 2 seconds is irrigation
+    time += 2000;
+    sampler.feed(2064, 20, time);
+
+    TEST_CHECK(sampler.interval() == 2000);
+}
+
+static void testFidelity(uint32_t irrigationRise)
+{
+    fidelity a = { 0, 0, 0, 0, 0 };
+    fidelity f = { 0, 0, 0, 0, 0 };
+    fidelity e = { 0, 0, 0, 0, 0 };
+    uint32_t delay = 0;
+
+    rise = irrigationRise;
+
+    // Sampler with the default settings
+    for (uint8_t phase = 0; phase < PHASES; phase++)
+    {
+        SoilSensorSampler adaptive(NULL);
+        SoilSensorSampler fixed(NULL);
+        SoilSensorSampler equal(NULL);
+
+        shift = phase * (SOIL_SENSOR_SAMPLER_INTERVAL_MAX / 1000 / PHASES);
+
+        fidelity result = run(&adaptive, 0);
+        fidelity shortest = run(&fixed, SOIL_SENSOR_SAMPLER_INTERVAL_MIN / 1000);
+
+        add(&a, result);
+        add(&f, shortest);
+        add(&e, run(&equal, DAY / result.samples));
+
+        if ((result.latency > shortest.latency) && (result.latency - shortest.latency > delay))
+        {
+            delay = result.latency - shortest.latency;
+        }
+    }
+
+    a = average(a);
+    f = average(f);
+    e = average(e);
+
+    printf("irrigation rising for %lu s\n", (unsigned long) rise);
+    print("adaptive", a);
+    print("fixed 2 s", f);
+    print("fixed same", e);
+
+    // Stable soil is sampled rarely
+    TEST_CHECK(a.samples * 100 < f.samples);
+
+    // An irrigation is reported at most one longest interval later than by sampling all the time
+    printf("adaptive reports irrigation at most %lu s later than fixed 2 s\n", (unsigned long) delay);
+    TEST_CHECK(delay <= SOIL_SENSOR_SAMPLER_INTERVAL_MAX / 1000);
+
+    // Samples saved on stable soil are spent better than by the fixed schedule
+    TEST_CHECK(a.meanError < e.meanError);
+}
+
+int main()
+{
+    testSlowDrift();
+    testFidelity(120);
+    testFidelity(1200);
+    testFidelity(3600);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,219 @@
+/*
+
+Trace of a blocking SoilSensor session on the simulated bus is replayed by the
+same driver and by the non-blocking measurement, which polls DS28E17 in
+another pattern. Replayed readings have to match and the modeled time of the
+measurement cycles has to follow the live time of the driver which is replayed.
+Two sensors whose ROMs end with the same CRC byte keep their own responses when
+the replay reads them in another order, a trace without ROM after select is
+still replayed.
+
+*/
+#include "test.h"
+#include "SimulatedBus.h"
+#include "OneWireTrace.h"
+
+#define CYCLES 3
+#define RECORDS 2000
+
+static oneWireTraceRecord records[RECORDS];
+static oneWireTraceRecord legacy[RECORDS];
+
+static bool measure(SoilSensor *sensor, bool blocking, uint16_t *moisture, float *temperature)
+{
+    if (blocking)
+    {
+        return sensor->readMoistureRaw(moisture) && sensor->readTemperatureCelsius(temperature);
+    }
+
+    sensor->startMeasurement();
+
+    while (!sensor->process())
+    {
+        delayMicroseconds(100);
+    }
+
+    return sensor->getMeasurement(moisture, temperature);
+}
+
+static uint32_t now(OneWireTraceReplay *replay)
+{
+    return replay != NULL ? replay->elapsed() : testMicros;
+}
+
+static uint32_t session(OneWireBus *bus, SimulatedBus *live, OneWireTraceReplay *replay, bool blocking, uint16_t *moisture, float *temperature)
+{
+    SoilSensor sensor(bus);
+
+    TEST_CHECK(sensor.begin());
+
+    uint32_t start = now(replay);
+
+    for (int i = 0; i < CYCLES; i++)
+    {
+        if (live != NULL)
+        {
+            live->sensors[0].moisture = 2000 + 10 * i;
+            live->sensors[0].temperature = 320 - 8 * i;
+        }
+
+        TEST_CHECK(measure(&sensor, blocking, &moisture[i], &temperature[i]));
+    }
+
+    return now(replay) - start;
+}
+
+static SimulatedBus *simulate(SimulatedBus *bus)
+{
+    bus->add(1, 2000, 320)->busyTime = 2500;
+
+    return bus;
+}
+
+static void checkReadings(uint16_t *moisture, float *temperature)
+{
+    for (int i = 0; i < CYCLES; i++)
+    {
+        TEST_CHECK(moisture[i] == 2000 + 10 * i);
+        TEST_CHECK(temperature[i] == (320 - 8 * i) * 0.0625);
+    }
+}
+
+static bool near(uint32_t modeled, uint32_t live, uint32_t percent)
+{
+    uint32_t difference = modeled > live ? modeled - live : live - modeled;
+
+    return difference * 100 <= live * percent;
+}
+
+static void testSharedCrc()
+{
+    SimulatedBus bus;
+    OneWireTraceRecorder recorder(&bus, records, RECORDS);
+    simulatedSensor *first = bus.add(1, 2000, 320);
+    simulatedSensor *second = bus.add(2, 2500, 400);
+    uint8_t other[8];
+
+    // Only the CRC byte of the first ROM is known to the second and third one
+    second->rom[2] = 0;
+
+    while (OneWire::crc8(second->rom, 7) != first->rom[7])
+    {
+        second->rom[2]++;
+    }
+
+    second->rom[7] = first->rom[7];
+    memcpy(other, second->rom, sizeof(other));
+    other[1] = 3;
+    other[2] = 0;
+
+    while (OneWire::crc8(other, 7) != first->rom[7])
+    {
+        other[2]++;
+    }
+
+    SoilSensor a(&recorder);
+    SoilSensor b(&recorder);
+    uint16_t moisture[2] = { 0, 0 };
+
+    TEST_CHECK(a.begin(first->rom) && b.begin(second->rom));
+    TEST_CHECK(a.readMoistureRaw(&moisture[0]) && b.readMoistureRaw(&moisture[1]));
+    TEST_CHECK((moisture[0] == 2000) && (moisture[1] == 2500));
+
+    OneWireTraceReplay replay(records, recorder.length());
+    SoilSensor replayedA(&replay);
+    SoilSensor replayedB(&replay);
+
+    memset(moisture, 0, sizeof(moisture));
+
+    TEST_CHECK(replayedB.begin(second->rom) && replayedA.begin(first->rom));
+    TEST_CHECK(replayedB.readMoistureRaw(&moisture[1]) && replayedA.readMoistureRaw(&moisture[0]));
+    TEST_CHECK((moisture[0] == 2000) && (moisture[1] == 2500));
+    TEST_CHECK(!replay.diverged());
+
+    // A device which was never selected does not answer for the one with its CRC byte
+    DS28E17 bridge(&replay);
+    uint8_t buffer[2];
+
+    bridge.setAddress(other);
+
+    TEST_CHECK(!bridge.read(ZSSC3123_ADDRESS, buffer, 2));
+}
+
+int main()
+{
+    uint16_t moisture[CYCLES];
+    float temperature[CYCLES];
+
+    SimulatedBus blockingBus;
+    OneWireTraceRecorder recorder(simulate(&blockingBus), records, RECORDS);
+    uint32_t liveBlocking = session(&recorder, &blockingBus, NULL, true, moisture, temperature);
+
+    checkReadings(moisture, temperature);
+    TEST_CHECK(recorder.length() < RECORDS);
+
+    SimulatedBus nonBlockingBus;
+    uint32_t liveNonBlocking = session(simulate(&nonBlockingBus), &nonBlockingBus, NULL, false, moisture, temperature);
+
+    OneWireTraceReplay replay(records, recorder.length());
+
+    memset(moisture, 0, sizeof(moisture));
+    uint32_t replayBlocking = session(&replay, NULL, &replay, true, moisture, temperature);
+
+    checkReadings(moisture, temperature);
+    TEST_CHECK(!replay.diverged());
+
+    replay.rewind();
+    memset(moisture, 0, sizeof(moisture));
+    uint32_t replayNonBlocking = session(&replay, NULL, &replay, false, moisture, temperature);
+
+    checkReadings(moisture, temperature);
+    TEST_CHECK(!replay.diverged());
+
+    // Trace recorded without ROM after select is matched by the CRC byte
+    uint16_t legacyLength = 0;
+
+    for (uint16_t i = 0; i < recorder.length(); i++)
+    {
+        if (records[i].op != ONEWIRE_TRACE_SELECT_ROM)
+        {
+            legacy[legacyLength++] = records[i];
+        }
+    }
+
+    OneWireTraceReplay legacyReplay(legacy, legacyLength);
+
+    TEST_CHECK(legacyLength < recorder.length());
+
+    memset(moisture, 0, sizeof(moisture));
+    session(&legacyReplay, NULL, &legacyReplay, true, moisture, temperature);
+
+    checkReadings(moisture, temperature);
+    TEST_CHECK(!legacyReplay.diverged());
+
+    printf("blocking      live %6lu us  replay %6lu us\n", (unsigned long) liveBlocking, (unsigned long) replayBlocking);
+    printf("non-blocking  live %6lu us  replay %6lu us\n", (unsigned long) liveNonBlocking, (unsigned long) replayNonBlocking);
+
+    TEST_CHECK(near(replayBlocking, liveBlocking, 5));
+    TEST_CHECK(near(replayNonBlocking, liveNonBlocking, 5));
+
+    // A request which was never recorded is reported
+    replay.rewind();
+    SoilSensor sensor(&replay);
+    uint8_t data[1] = { 0x55 };
+
+    TEST_CHECK(sensor.begin());
+    TEST_CHECK(!replay.diverged());
+
+    DS28E17 bridge(&replay);
+    uint8_t rom[8];
+    sensor.getAddress(rom);
+    bridge.setAddress(rom);
+
+    TEST_CHECK(!bridge.write(0x10, data, 1));
+    TEST_CHECK(replay.diverged());
+
+    testSharedCrc();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,226 @@
+/*
+
+OneWireUartBus against the loopback model of the line: presence, search of all
+devices and of one family, Match ROM with a function read. A request is queued
+by write() at the cost of a few calls and finishes while the application only
+calls isIdle(), the echoes never overflow the receive buffer and a line which
+is not looped back does not hang the bus. A soil sensor bridged over the line
+is measured by startMeasurement() and process() while the CPU is mostly free.
+
+*/
+#include "test.h"
+#include "LoopbackUart.h"
+#include "OneWireUart.h"
+#include "SoilSensor.h"
+
+#define REQUEST 17
+
+static void testPresence()
+{
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+
+    bus.begin();
+
+    TEST_CHECK(bus.reset() == 0);
+
+    uart.add(0x19, 1);
+
+    TEST_CHECK(bus.reset() == 1);
+}
+
+static void testSearch()
+{
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+    uint8_t rom[8];
+    uint8_t found = 0;
+    uint8_t foundFamily = 0;
+
+    uart.add(0x19, 1);
+    uart.add(0x28, 2);
+    uart.add(0x19, 3);
+    bus.begin();
+
+    bus.reset_search();
+
+    while (bus.search(rom))
+    {
+        TEST_CHECK(OneWire::crc8(rom, 7) == rom[7]);
+        found |= 1 << rom[1];
+    }
+
+    TEST_CHECK(found == 0x0E);
+
+    bus.target_search(0x19);
+
+    while (bus.search(rom) && (rom[0] == 0x19))
+    {
+        foundFamily++;
+    }
+
+    TEST_CHECK(foundFamily == 2);
+}
+
+static void testFunction()
+{
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+    loopbackDevice *device = uart.add(0x19, 0x42);
+
+    uart.add(0x19, 0x43);
+    bus.begin();
+
+    TEST_CHECK(bus.reset());
+    bus.select(device->rom);
+    bus.write(LOOPBACK_UART_FUNCTION);
+
+    TEST_CHECK(bus.read() == 0x42);
+    TEST_CHECK(bus.read() == (uint8_t) ~0x42);
+}
+
+static void testBackground()
+{
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+    loopbackDevice *device = uart.add(0x19, 0x42);
+    uint8_t request[REQUEST - 9];
+
+    memset(request, 0x4B, sizeof(request));
+    bus.begin();
+    bus.reset();
+
+    // Select and a DS28E17 sized request, 136 slots
+    unsigned long start = testMicros;
+
+    bus.select(device->rom);
+    bus.write_bytes(request, sizeof(request));
+
+    unsigned long queued = testMicros - start;
+    uint32_t polls = 0;
+
+    // The application does other work and polls once in a millisecond
+    while (!bus.isIdle())
+    {
+        delay(1);
+        polls++;
+    }
+
+    unsigned long busTime = testMicros - start;
+
+    printf("%d bytes  queued in %lu us  on the line %lu us  %lu polls\n",
+           REQUEST, queued, busTime, (unsigned long) polls);
+
+    TEST_CHECK(queued * 20 < busTime);
+    TEST_CHECK(busTime >= REQUEST * 8 * 86UL);
+    TEST_CHECK(uart.overflows == 0);
+
+    // A write longer than the queue waits only for its first slots
+    uint8_t longRequest[ONEWIRE_UART_QUEUE + 8];
+
+    memset(longRequest, 0x4B, sizeof(longRequest));
+    bus.reset();
+    bus.skip();
+    bus.write_bytes(longRequest, sizeof(longRequest));
+
+    while (!bus.isIdle())
+    {
+        delay(1);
+    }
+
+    TEST_CHECK(uart.overflows == 0);
+
+    // Queued slots are on the line before a read
+    bus.reset();
+    bus.select(device->rom);
+    bus.write(LOOPBACK_UART_FUNCTION);
+
+    TEST_CHECK(bus.read() == 0x42);
+}
+
+static void testNotLooped()
+{
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+
+    uart.add(0x19, 1);
+    uart.looped = false;
+    bus.begin();
+
+    TEST_CHECK(bus.reset() == 0);
+
+    bus.skip();
+    bus.write(0x4B);
+
+    while (!bus.isIdle())
+    {
+        delay(1);
+    }
+
+    TEST_CHECK(bus.read() == 0);
+}
+
+static void testMeasurement()
+{
+    SimulatedBus sensors;
+    simulatedSensor *simulated = sensors.add(1, 3000, 320);
+    LoopbackUart uart;
+    OneWireUartBus bus(&uart);
+    SoilSensor sensor(&bus);
+
+    // I2C transfer of a few bytes
+    simulated->busyTime = 500;
+    uart.addBridge(&sensors, simulated);
+    bus.begin();
+
+    TEST_CHECK(sensor.begin(simulated->rom));
+
+    uint16_t moisture = 0;
+    int16_t temperature = 0;
+    unsigned long start = testMicros;
+
+    TEST_CHECK(sensor.readMoistureRaw(&moisture) && sensor.readTemperatureRaw(&temperature));
+    TEST_CHECK((moisture == 3000) && (temperature == 320));
+
+    unsigned long blocking = testMicros - start;
+
+    // The application polls process() every 200 us and does other work in between
+    simulated->moisture = 3010;
+    start = testMicros;
+
+    TEST_CHECK(sensor.startMeasurement());
+
+    unsigned long inside = testMicros - start;
+    bool done = false;
+
+    while (!done)
+    {
+        delayMicroseconds(200);
+
+        unsigned long poll = testMicros;
+        done = sensor.process();
+        inside += testMicros - poll;
+    }
+
+    unsigned long nonBlocking = testMicros - start;
+    float celsius = 0;
+
+    TEST_CHECK(sensor.getMeasurement(&moisture, &celsius));
+    TEST_CHECK((moisture == 3010) && (celsius == 20));
+
+    printf("measurement  blocking %lu us  non-blocking %lu us of which %lu us in process()\n", blocking, nonBlocking, inside);
+
+    TEST_CHECK(inside * 2 < nonBlocking);
+}
+
+int main()
+{
+    testPresence();
+    testSearch();
+    testFunction();
+    testBackground();
+    testNotLooped();
+    testMeasurement();
+
+    return TEST_RESULT();
+}